@@ -150,7 +150,18 @@ int dirtree_recurse(struct dirtree *node,
 
   // The extra parentheses are to shut the stupid compiler up.
   while ((entry = readdir(dir))) {
-    if (!(new = dirtree_add_node(node, entry->d_name, flags))) continue;
+
+    // If the caller just wants names and types, use what readdir() told us.
+    if ((flags & DIRTREE_STATLESS) && entry->d_type != DT_UNKNOWN
+        && entry->d_type != DT_DIR
+        && (entry->d_type != DT_LNK || !(flags & DIRTREE_SYMFOLLOW)))
+    {
+      new = xzalloc(sizeof(struct dirtree)+strlen(entry->d_name)+1);
+      new->parent = node;
+      new->st.st_mode = DTTOIF(entry->d_type);
+      new->st.st_ino = entry->d_ino;
+      strcpy(new->name, entry->d_name);
+    } else if (!(new = dirtree_add_node(node, entry->d_name, flags))) continue;
     new = dirtree_handle_callback(new, callback);
     if (new == DIRTREE_ABORTVAL) break;
     if (new) {
@@ -493,6 +493,51 @@ char *readfile(char *name, char *ibuf, off_t len)
   return readfileat(AT_FDCWD, name, ibuf, &len);
 }
 
+// Reread a file (such as /proc/stat) through an fd kept open in rr, growing
+// rr->buf until the whole thing fits. Returns null terminated contents or 0.
+char *reread(struct reread *rr, char *name)
+{
+  ssize_t len;
+
+  if (!rr->buf) {
+    if (-1 == (rr->fd = open(name, O_RDONLY|O_CLOEXEC))) return 0;
+    rr->buf = xmalloc(rr->size = 4096);
+  }
+  while (0<(len = pread(rr->fd, rr->buf, rr->size-1, 0)) && len == rr->size-1)
+    rr->buf = xrealloc(rr->buf, rr->size *= 2);
+  if (len<0) return 0;
+  rr->buf[rr->len = len] = 0;
+
+  return rr->buf;
+}
+
+// Find the value after "key" at the start of a line of reread() data. Looks
+// where *hint says it was last time before searching, and updates *hint.
+char *reread_key(struct reread *rr, char *key, unsigned *hint)
+{
+  char *s = rr->buf+*hint;
+  int len = strlen(key);
+
+  if (*hint >= rr->len || strncmp(s, key, len) || (*hint && s[-1] != '\n')) {
+    // Numbers before it only grow or shrink a little between samples.
+    s = rr->buf+(*hint>256 ? *hint-256 : 0);
+    if (s>rr->buf+rr->len) s = rr->buf;
+    for (;;) {
+      if (s == rr->buf || s[-1] == '\n') if (!strncmp(s, key, len)) break;
+      if (!(s = strchr(s, '\n'))) {
+        if (*hint<257) return 0;
+        *hint = 0;
+
+        return reread_key(rr, key, hint);
+      }
+      s++;
+    }
+    *hint = s-rr->buf;
+  }
+
+  return s+len;
+}
+
 // Sleep for this many thousandths of a second
 void msleep(long miliseconds)
 {
@@ -941,28 +986,153 @@ char *getbasename(char *name)
 }
 
 // Execute a callback for each PID that matches a process name from a list.
+// Absolute paths must match argv[0] exactly, other names compare basenames
+// (looked up in a hash table). If several names
+// match, the callback gets the first one in the list.
 void names_to_pid(char **names, int (*callback)(pid_t pid, char *name))
 {
   DIR *dp;
   struct dirent *entry;
+  unsigned *hash, *next, mask, count, h, i, j, k, abs = 0;
+  char *s;
+
+  // Hash each basename to the first name using it, and chain every name to
+  // the next one with the same basename (absolute names get their own chain)
+  // so matches come out in list order.
+  for (count = 0; names[count]; count++);
+  for (mask = 15; mask<2*count; mask = 2*mask+1);
+  hash = xzalloc((mask+1+count)*sizeof(unsigned));
+  next = hash+mask+1;
+  for (i = count; i--;) {
+    if (*names[i] == '/') {
+      next[i] = abs;
+      abs = i+1;
+
+      continue;
+    }
+    for (h = 0, s = getbasename(names[i]); *s; s++) h = h*31+*s;
+    for (s = getbasename(names[i]);; h++) {
+      if ((j = hash[h&=mask]) && strcmp(getbasename(names[j-1]), s)) continue;
+      next[i] = j;
+      hash[h] = i+1;
+      break;
+    }
+  }
 
   if (!(dp = opendir("/proc"))) perror_exit("opendir");
 
   while ((entry = readdir(dp))) {
     unsigned u;
-    char *cmd, **curname;
+    int fd, len;
+    char *cmd = libbuf;
 
     if (!(u = atoi(entry->d_name))) continue;
-    sprintf(libbuf, "/proc/%u/cmdline", u);
-    if (!(cmd = readfile(libbuf, libbuf, sizeof(libbuf)))) continue;
-
-    for (curname = names; *curname; curname++)
-      if (**curname == '/' ? !strcmp(cmd, *curname)
-          : !strcmp(getbasename(cmd), getbasename(*curname)))
-        if (callback(u, *curname)) break;
-    if (*curname) break;
+
+    // Only argv[0] matters, don't bother building a path or sizing the file.
+    sprintf(libbuf, "%u/cmdline", u);
+    if (-1 == (fd = openat(dirfd(dp), libbuf, O_RDONLY))) continue;
+    len = read(fd, libbuf, sizeof(libbuf)-1);
+    close(fd);
+    if (len<1) continue;
+    libbuf[len] = 0;
+
+    for (h = 0, s = getbasename(cmd); *s; s++) h = h*31+*s;
+    for (s = getbasename(cmd); (i = hash[h&=mask]); h++)
+      if (!strcmp(getbasename(names[i-1]), s)) break;
+
+    // Merge the basename and absolute chains, stopping when callback says so.
+    for (j = abs; i || j;) {
+      if (j && (!i || j<i)) {
+        j = next[(k = j)-1];
+        if (strcmp(cmd, names[k-1])) continue;
+      } else i = next[(k = i)-1];
+      if (callback(u, names[k-1])) goto done;
+    }
   }
+done:
   closedir(dp);
+  free(hash);
+}
+
+static int pidcmp(const void *a, const void *b)
+{
+  return *(pid_t *)a - *(pid_t *)b;
+}
+
+// Call callback(pid) for each of count pids (or each PID in /proc if pids is
+// NULL), with up to "jobs" forked workers each handling a batch of consecutive
+// entries. A worker's stdout goes to its own temp file, copied to our stdout
+// in list order as batches complete (preceded by header if any batch produced
+// output).
+void pids_parallel(int jobs, pid_t *list, int count,
+  void (*callback)(pid_t pid), char *header)
+{
+  DIR *dp;
+  struct dirent *entry;
+  pid_t *pids = list, *kids;
+  FILE **out;
+  int batches, per, next, done, running = 0, i, j, status;
+
+  if (!pids) {
+    if (!(dp = opendir("/proc"))) perror_exit("opendir");
+    for (count = 0; (entry = readdir(dp));) {
+      if (!(i = atoi(entry->d_name))) continue;
+      if (!(count&1023)) pids = xrealloc(pids, (count+1024)*sizeof(pid_t));
+      pids[count++] = i;
+    }
+    closedir(dp);
+    qsort(pids, count, sizeof(pid_t), pidcmp);
+  }
+
+  // Without fork (or anything to defer) just run them in order here.
+  if (!CFG_TOYBOX_FORK || !count || (jobs<2 && !header)) {
+    if (header && count) xputs(header);
+    for (i = 0; i<count; i++) callback(pids[i]);
+    if (pids != list) free(pids);
+
+    return;
+  }
+  // Several batches per worker so one big process doesn't stall the rest.
+  if ((batches = jobs*4)>count) batches = count;
+  per = (count+batches-1)/batches;
+  batches = (count+per-1)/per;
+  kids = xzalloc(batches*sizeof(pid_t));
+  out = xmalloc(batches*sizeof(FILE *));
+
+  xflush();
+  for (next = done = 0; done<batches;) {
+    while (next<batches && running<jobs) {
+      if (!(out[next] = tmpfile())) perror_exit("tmpfile");
+      if (!(kids[next] = xfork())) {
+        dup2(fileno(out[next]), 1);
+        for (i = next*per; i<count && i<(next+1)*per; i++) callback(pids[i]);
+        xflush();
+        _exit(toys.exitval);
+      }
+      next++;
+      running++;
+    }
+
+    // Reap whichever worker finishes, then emit every leading finished batch.
+    if (0>(j = wait(&status))) perror_exit("wait");
+    for (i = done; i<next; i++) if (kids[i] == j) break;
+    if (i == next) continue;
+    kids[i] = 0;
+    running--;
+    if (!WIFEXITED(status) || WEXITSTATUS(status)) toys.exitval = 1;
+    while (done<next && !kids[done]) {
+      if (lseek(fileno(out[done]), 0, SEEK_END)>0) {
+        if (header) xputs(header);
+        header = 0;
+        lseek(fileno(out[done]), 0, SEEK_SET);
+        xsendfile(fileno(out[done]), 1);
+      }
+      fclose(out[done++]);
+    }
+  }
+  free(out);
+  free(kids);
+  if (pids != list) free(pids);
 }
 
 // display first few digits of number with power of two units
@@ -1085,7 +1255,66 @@ int dev_makedev(int major, int minor)
   return (minor&0xff)|((major&0xfff)<<8)|((minor&0xfff00)<<12);
 }
 
-// Return cached passwd entries.
+// Hash dev+ino into a table index. The multiplier spreads sequential inode
+// numbers (which is what every filesystem hands out) across the table.
+static unsigned long inode_slot(struct inode_hash *ih, dev_t dev, ino_t ino)
+{
+  unsigned long long hh = (ino^((unsigned long long)dev<<32))
+    *0x9E3779B97F4A7C15ULL;
+
+  return (hh>>32)&(ih->size-1);
+}
+
+// Look up dev+ino, returning previously recorded entry if we've seen it
+// before. Otherwise add it (with a copy of name if not NULL) and return 0.
+// This is an open addressing (linear probe) table that doubles when 3/4 full.
+// An all-zero dev+ino marks an empty slot, neither is valid for a real file.
+struct inode_entry *seen_inode(struct inode_hash *ih, dev_t dev, ino_t ino,
+  char *name)
+{
+  struct inode_entry *ie;
+  unsigned long i;
+
+  if ((ih->used+1)*4 > ih->size*3) {
+    struct inode_hash new = {ih->size ? ih->size*2 : 256, ih->used, 0};
+
+    new.table = xzalloc(new.size*sizeof(*new.table));
+    for (i = 0; i<ih->size; i++) {
+      unsigned long j;
+
+      if (!(ie = ih->table+i)->dev && !ie->ino) continue;
+      for (j = inode_slot(&new, ie->dev, ie->ino); new.table[j].dev
+           || new.table[j].ino; j = (j+1)&(new.size-1));
+      new.table[j] = *ie;
+    }
+    free(ih->table);
+    *ih = new;
+  }
+
+  for (i = inode_slot(ih, dev, ino);; i = (i+1)&(ih->size-1)) {
+    ie = ih->table+i;
+    if (!ie->dev && !ie->ino) break;
+    if (ie->dev == dev && ie->ino == ino) return ie;
+  }
+  ie->dev = dev;
+  ie->ino = ino;
+  ie->name = name ? xstrdup(name) : 0;
+  ih->used++;
+
+  return 0;
+}
+
+void free_inode_hash(struct inode_hash *ih)
+{
+  unsigned long i;
+
+  for (i = 0; i<ih->size; i++) free(ih->table[i].name);
+  free(ih->table);
+  memset(ih, 0, sizeof(*ih));
+}
+
+// Return cached passwd entries. Lookups that found nothing are cached too,
+// so unknown uids don't go back to NSS for every file.
 struct passwd *bufgetpwuid(uid_t uid)
 {
   struct pwuidbuf_list {
@@ -1093,27 +1322,33 @@ struct passwd *bufgetpwuid(uid_t uid)
     struct passwd pw;
   } *list;
   struct passwd *temp;
-  static struct pwuidbuf_list *pwuidbuf;
+  static struct pwuidbuf_list *pwuidbuf[64];
+  unsigned hash = uid%ARRAY_LEN(pwuidbuf);
 
-  for (list = pwuidbuf; list; list = list->next)
-    if (list->pw.pw_uid == uid) return &(list->pw);
+  for (list = pwuidbuf[hash]; list; list = list->next)
+    if (list->pw.pw_uid == uid) return list->pw.pw_name ? &(list->pw) : 0;
 
   list = xmalloc(512);
-  list->next = pwuidbuf;
+  list->next = pwuidbuf[hash];
 
   errno = getpwuid_r(uid, &list->pw, sizeof(*list)+(char *)list,
     512-sizeof(*list), &temp);
   if (!temp) {
-    free(list);
+    if (errno) {
+      free(list);
 
-    return 0;
+      return 0;
+    }
+    list = xrealloc(list, sizeof(*list));
+    memset(&list->pw, 0, sizeof(list->pw));
+    list->pw.pw_uid = uid;
   }
-  pwuidbuf = list;
+  pwuidbuf[hash] = list;
 
-  return &list->pw;
+  return temp ? &list->pw : 0;
 }
 
-// Return cached passwd entries.
+// Return cached group entries. Lookups that found nothing are cached too.
 struct group *bufgetgrgid(gid_t gid)
 {
   struct grgidbuf_list {
@@ -1121,24 +1356,30 @@ struct group *bufgetgrgid(gid_t gid)
     struct group gr;
   } *list;
   struct group *temp;
-  static struct grgidbuf_list *grgidbuf;
+  static struct grgidbuf_list *grgidbuf[64];
+  unsigned hash = gid%ARRAY_LEN(grgidbuf);
 
-  for (list = grgidbuf; list; list = list->next)
-    if (list->gr.gr_gid == gid) return &(list->gr);
+  for (list = grgidbuf[hash]; list; list = list->next)
+    if (list->gr.gr_gid == gid) return list->gr.gr_name ? &(list->gr) : 0;
 
   list = xmalloc(512);
-  list->next = grgidbuf;
+  list->next = grgidbuf[hash];
 
   errno = getgrgid_r(gid, &list->gr, sizeof(*list)+(char *)list,
     512-sizeof(*list), &temp);
   if (!temp) {
-    free(list);
+    if (errno) {
+      free(list);
 
-    return 0;
+      return 0;
+    }
+    list = xrealloc(list, sizeof(*list));
+    memset(&list->gr, 0, sizeof(list->gr));
+    list->gr.gr_gid = gid;
   }
-  grgidbuf = list;
+  grgidbuf[hash] = list;
 
-  return &list->gr;
+  return temp ? &list->gr : 0;
 }
 
 // Always null terminates, returns 0 for failure, len for success
@@ -1159,23 +1400,33 @@ int readlink0(char *path, char *buf, int len)
 }
 
 // Do regex matching handling embedded NUL bytes in string (hence extra len
-// argument). Note that neither the pattern nor the match can currently include
-// NUL bytes (even with wildcards) and string must be null terminated at
-// string[len]. But this can find a match after the first NUL.
+// argument). The pattern can't include NUL bytes and string must be null
+// terminated at string[len]. But this can find a match after the first NUL.
 int regexec0(regex_t *preg, char *string, long len, int nmatch,
   regmatch_t pmatch[], int eflags)
 {
+#ifdef REG_STARTEND
+  // Let libc match the whole length in one pass instead of calling it again
+  // for each NUL-separated segment (which rescanned each for its length).
+  regmatch_t backup;
+
+  if (!nmatch) pmatch = &backup;
+  pmatch->rm_so = 0;
+  pmatch->rm_eo = len;
+
+  return regexec(preg, string, nmatch, pmatch, eflags|REG_STARTEND);
+#else
   char *s = string;
 
   for (;;) {
-    long ll = 0;
+    long ll;
     int rc;
 
     while (len && !*s) {
       s++;
       len--;
     }
-    while (s[ll] && ll<len) ll++;
+    ll = strnlen(s, len);
 
     rc = regexec(preg, s, nmatch, pmatch, eflags);
     if (!rc) {
@@ -1191,6 +1442,7 @@ int regexec0(regex_t *preg, char *string, long len, int nmatch,
     s += ll;
     len -= ll;
   }
+#endif
 }
 
 // Return user name or string representation of number, returned buffer
@@ -1200,8 +1452,10 @@ char *getusername(uid_t uid)
   struct passwd *pw = bufgetpwuid(uid);
   static char unum[12];
 
+  if (pw) return pw->pw_name;
   sprintf(unum, "%u", (unsigned)uid);
-  return pw ? pw->pw_name : unum;
+
+  return unum;
 }
 
 // Return group name or string representation of number, returned buffer
@@ -1211,8 +1465,10 @@ char *getgroupname(gid_t gid)
   struct group *gr = bufgetgrgid(gid);
   static char gnum[12];
 
+  if (gr) return gr->gr_name;
   sprintf(gnum, "%u", (unsigned)gid);
-  return gr ? gr->gr_name : gnum;
+
+  return gnum;
 }
 
 // Iterate over lines in file, calling function. Function can write 0 to
@@ -40,6 +40,11 @@ struct num_cache {
   char data[];
 };
 
+struct num_hash {
+  struct num_cache **table;
+  unsigned mask, count;
+};
+
 void llist_free_arg(void *node);
 void llist_free_double(void *node);
 void llist_traverse(void *list, void (*using)(void *node));
@@ -51,6 +56,10 @@ void *dlist_terminate(void *list);
 struct num_cache *get_num_cache(struct num_cache *cache, long long num);
 struct num_cache *add_num_cache(struct num_cache **cache, long long num,
   void *data, int len);
+struct num_cache *get_num_hash(struct num_hash *hash, long long num);
+struct num_cache *add_num_hash(struct num_hash *hash, long long num,
+  void *data, int len);
+void free_num_hash(struct num_hash *hash);
 
 // args.c
 void get_optflags(void);
@@ -73,6 +82,9 @@ void get_optflags(void);
 #define DIRTREE_SHUTUP      16
 // Breadth first traversal, conserves filehandles at the expense of memory
 #define DIRTREE_BREADTH     32
+// Only stat() directories and followed symlinks, other children just get
+// st_mode file type and st_ino from readdir() (and no ->symlink)
+#define DIRTREE_STATLESS    64
 // Don't look at any more files in this directory.
 #define DIRTREE_ABORT      256
 
@@ -171,6 +183,12 @@ char *xtzset(char *new);
 void xsignal(int signal, void *handler);
 
 // lib.c
+struct reread {
+  int fd;
+  unsigned len, size;
+  char *buf;
+};
+
 void verror_msg(char *msg, int err, va_list va);
 void error_msg(char *msg, ...) printf_format;
 void perror_msg(char *msg, ...) printf_format;
@@ -188,6 +206,8 @@ int mkpathat(int atfd, char *dir, mode_t lastmode, int flags);
 struct string_list **splitpath(char *path, struct string_list **list);
 char *readfileat(int dirfd, char *name, char *buf, off_t *len);
 char *readfile(char *name, char *buf, off_t len);
+char *reread(struct reread *rr, char *name);
+char *reread_key(struct reread *rr, char *key, unsigned *hint);
 void msleep(long miliseconds);
 int64_t peek_le(void *ptr, unsigned size);
 int64_t peek_be(void *ptr, unsigned size);
@@ -224,6 +244,21 @@ char *strnstr(char *line, char *str);
 int dev_minor(int dev);
 int dev_major(int dev);
 int dev_makedev(int major, int minor);
+
+struct inode_entry {
+  dev_t dev;
+  ino_t ino;
+  char *name;
+};
+
+struct inode_hash {
+  unsigned long size, used;
+  struct inode_entry *table;
+};
+
+struct inode_entry *seen_inode(struct inode_hash *ih, dev_t dev, ino_t ino,
+  char *name);
+void free_inode_hash(struct inode_hash *ih);
 struct passwd *bufgetpwuid(uid_t uid);
 struct group *bufgetgrgid(gid_t gid);
 int readlinkat0(int dirfd, char *path, char *buf, int len);
@@ -317,6 +352,8 @@ mode_t string_to_mode(char *mode_str, mode_t base);
 void mode_to_string(mode_t mode, char *buf);
 char *getbasename(char *name);
 void names_to_pid(char **names, int (*callback)(pid_t pid, char *name));
+void pids_parallel(int jobs, pid_t *pids, int count,
+  void (*callback)(pid_t pid), char *header);
 
 pid_t xvforkwrap(pid_t pid);
 #define XVFORK() xvforkwrap(vfork())
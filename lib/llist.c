@@ -128,3 +128,55 @@ struct num_cache *add_num_cache(struct num_cache **cache, long long num,
 
   return 0;
 }
+
+// Hashed version of the above for caches too big to walk linearly.
+static struct num_cache **num_hash_chain(struct num_hash *hash, long long num)
+{
+  return hash->table+((num^(num>>17))&hash->mask);
+}
+
+struct num_cache *get_num_hash(struct num_hash *hash, long long num)
+{
+  if (!hash->table) return 0;
+
+  return get_num_cache(*num_hash_chain(hash, num), num);
+}
+
+// Uniquely add num+data to hash, returns existing entry if already there.
+struct num_cache *add_num_hash(struct num_hash *hash, long long num,
+  void *data, int len)
+{
+  struct num_cache *nc, **old;
+  unsigned i;
+
+  // Double the table when chains would average more than one entry.
+  if (hash->count >= hash->mask) {
+    i = hash->mask;
+    old = hash->table;
+    hash->mask = old ? 2*i+1 : 255;
+    hash->table = xzalloc((hash->mask+1)*sizeof(struct num_cache *));
+    if (old) {
+      for (i++; i--;) while ((nc = old[i])) {
+        old[i] = nc->next;
+        nc->next = *num_hash_chain(hash, nc->num);
+        *num_hash_chain(hash, nc->num) = nc;
+      }
+      free(old);
+    }
+  }
+
+  nc = add_num_cache(num_hash_chain(hash, num), num, data, len);
+  if (!nc) hash->count++;
+
+  return nc;
+}
+
+void free_num_hash(struct num_hash *hash)
+{
+  unsigned i;
+
+  if (hash->table) for (i = 0; i<=hash->mask; i++)
+    llist_traverse(hash->table[i], free);
+  free(hash->table);
+  memset(hash, 0, sizeof(*hash));
+}
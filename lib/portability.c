@@ -5,6 +5,7 @@
  */
 
 #include "toys.h"
+#include <sys/syscall.h>
 
 // We can't fork() on nommu systems, and vfork() requires an exec() or exit()
 // before resuming the parent (because they share a heap until then). And no,
@@ -92,3 +93,68 @@ int clearenv(void)
   return 0;
 }
 #endif
+
+// Like fstatat() but only the fields in mask (STATX_ bits, plus st_dev which
+// is always filled out) have to be valid, which saves network and FUSE
+// filesystems work. Fields not in mask may be left zero.
+int stat_fields(int dirfd, char *name, struct stat *st, int flags,
+  unsigned mask)
+{
+#if defined(__NR_statx) && defined(STATX_BASIC_STATS)
+  static int nostatx;
+  struct statx sx;
+
+  if (!nostatx) {
+    if (!syscall(__NR_statx, dirfd, name, flags, mask, &sx)) {
+      unsigned got = sx.stx_mask;
+
+      // Zero whatever the filesystem couldn't supply, asked for or not.
+      memset(st, 0, sizeof(*st));
+      st->st_dev = dev_makedev(sx.stx_dev_major, sx.stx_dev_minor);
+      st->st_rdev = dev_makedev(sx.stx_rdev_major, sx.stx_rdev_minor);
+      st->st_blksize = sx.stx_blksize;
+      if (got&STATX_TYPE) st->st_mode = sx.stx_mode&S_IFMT;
+      if (got&STATX_MODE) st->st_mode |= sx.stx_mode&~S_IFMT;
+      if (got&STATX_INO) st->st_ino = sx.stx_ino;
+      if (got&STATX_NLINK) st->st_nlink = sx.stx_nlink;
+      if (got&STATX_UID) st->st_uid = sx.stx_uid;
+      if (got&STATX_GID) st->st_gid = sx.stx_gid;
+      if (got&STATX_SIZE) st->st_size = sx.stx_size;
+      if (got&STATX_BLOCKS) st->st_blocks = sx.stx_blocks;
+      if (got&STATX_ATIME) {
+        st->st_atim.tv_sec = sx.stx_atime.tv_sec;
+        st->st_atim.tv_nsec = sx.stx_atime.tv_nsec;
+      }
+      if (got&STATX_MTIME) {
+        st->st_mtim.tv_sec = sx.stx_mtime.tv_sec;
+        st->st_mtim.tv_nsec = sx.stx_mtime.tv_nsec;
+      }
+      if (got&STATX_CTIME) {
+        st->st_ctim.tv_sec = sx.stx_ctime.tv_sec;
+        st->st_ctim.tv_nsec = sx.stx_ctime.tv_nsec;
+      }
+
+      return 0;
+    }
+    // Container seccomp filters often say EPERM rather than ENOSYS.
+    if (errno != ENOSYS && errno != EPERM) return -1;
+    nostatx++;
+  }
+#endif
+
+  return fstatat(dirfd, name, st, flags);
+}
+
+// Have the kernel copy len bytes from in (at *inoff, which is advanced) to
+// out's current position, sharing blocks where the filesystem can. Returns
+// bytes copied, or -1 (with ENOSYS if copy_file_range() isn't available).
+long copy_range(int in, off_t *inoff, int out, long len)
+{
+#ifdef __NR_copy_file_range
+  return syscall(__NR_copy_file_range, in, inoff, out, 0, len, 0);
+#else
+  errno = ENOSYS;
+
+  return -1;
+#endif
+}
@@ -82,6 +82,11 @@ char *dirname(char *path);
 char *__xpg_basename(char *path);
 static inline char *basename(char *path) { return __xpg_basename(path); }
 
+// Every libc has these, but glibc only admits it with _GNU_SOURCE.
+void *memmem(const void *haystack, size_t haystacklen, const void *needle,
+  size_t needlelen);
+void *memrchr(const void *s, int c, size_t n);
+
 // uClibc pretends to be glibc and copied a lot of its bugs, but has a few more
 #if defined(__UCLIBC__)
 #include <unistd.h>
@@ -213,6 +218,28 @@ ssize_t getline(char **lineptr, size_t *n, FILE *stream);
 #include <sys/mount.h>
 #include <sys/swap.h>
 
+// statx() (Linux 4.11) lets the filesystem skip fields we didn't ask for.
+// With older headers stat_fields() falls back to fstatat().
+#include <linux/stat.h>
+#ifndef STATX_BLOCKS
+#define STATX_TYPE   0x00000001U
+#define STATX_MODE   0x00000002U
+#define STATX_NLINK  0x00000004U
+#define STATX_UID    0x00000008U
+#define STATX_GID    0x00000010U
+#define STATX_ATIME  0x00000020U
+#define STATX_MTIME  0x00000040U
+#define STATX_CTIME  0x00000080U
+#define STATX_INO    0x00000100U
+#define STATX_SIZE   0x00000200U
+#define STATX_BLOCKS 0x00000400U
+#endif
+int stat_fields(int dirfd, char *name, struct stat *st, int flags,
+  unsigned mask);
+
+// copy_file_range() (Linux 4.5), not in older libc headers.
+long copy_range(int in, off_t *inoff, int out, long len);
+
 // Android is missing some headers and functions
 // "generated/config.h" is included first
 #if CFG_TOYBOX_SHADOW
@@ -30,9 +30,12 @@ config NETSTAT
 #define FOR_netstat
 #include "toys.h"
 #include <net/route.h>
+#include <linux/netlink.h>
+#include <linux/sock_diag.h>
+#include <linux/inet_diag.h>
 
 GLOBALS(
-  struct num_cache *inodes;
+  struct num_hash inodes;
   int wpad;
 );
 
@@ -100,25 +103,128 @@ static void addr2str(int af, void *addr, unsigned port, char *buf, int len,
   else sprintf(buf+pos, ":%u", port);
 }
 
-// Display info for tcp/udp/raw
-static void show_ip(char *fname)
+// Display one tcp/udp/raw socket if the -a/-l selection wants it
+static void show_ip_sock(char *label, int af, void *laddr, unsigned lport,
+  void *raddr, unsigned rport, unsigned state, unsigned txq, unsigned rxq,
+  unsigned uid, unsigned long inode)
 {
-  char *ss_state = "UNKNOWN", buf[12], *s, *label = strrchr(fname, '/')+1;
+  char *ss_state = "UNKNOWN", buf[12], *s, lip[256], rip[256];
   char *state_label[] = {"", "ESTABLISHED", "SYN_SENT", "SYN_RECV", "FIN_WAIT1",
                          "FIN_WAIT2", "TIME_WAIT", "CLOSE", "CLOSE_WAIT",
                          "LAST_ACK", "LISTEN", "CLOSING", "UNKNOWN"};
   struct passwd *pw;
-  FILE *fp = fopen(fname, "r");
 
-  if (!fp) {
-     perror_msg("'%s'", fname);
-     return;
+  // Should we display this? Servers have no remote end (tcp LISTEN, or
+  // unconnected udp/raw): -l shows only those, default only the others.
+  if (!(toys.optflags & FLAG_a)
+    && !(toys.optflags & FLAG_l) == (!rport && (state & 0xA))) return;
+
+  addr2str(af, laddr, lport, lip, TT.wpad, label);
+  addr2str(af, raddr, rport, rip, TT.wpad, label);
+
+  // Display data
+  s = label;
+  if (strstart(&s, "tcp")) {
+    int sz = ARRAY_LEN(state_label);
+    if (!state || state >= sz) state = sz-1;
+    ss_state = state_label[state];
+  } else if (strstart(&s, "udp")) {
+    if (state == 1) ss_state = state_label[state];
+    else if (state == 7) ss_state = "";
+  } else if (strstart(&s, "raw")) sprintf(ss_state = buf, "%u", state);
+
+  if (!(toys.optflags & FLAG_n) && (pw = bufgetpwuid(uid)))
+    snprintf(toybuf, sizeof(toybuf), "%s", pw->pw_name);
+  else snprintf(toybuf, sizeof(toybuf), "%d", uid);
+
+  printf("%-6s%6d%7d ", label, rxq, txq);
+  printf("%*.*s %*.*s ", -TT.wpad, TT.wpad, lip, -TT.wpad, TT.wpad, rip);
+  printf("%-11s", ss_state);
+  if ((toys.optflags & FLAG_e)) printf(" %-10s %-11ld", toybuf, inode);
+  if ((toys.optflags & FLAG_p)) {
+    struct num_cache *nc = get_num_hash(&TT.inodes, inode);
+
+    printf(" %s", nc ? nc->data : "-");
   }
+  putchar('\n');
+}
 
-  if(!fgets(toybuf, sizeof(toybuf), fp)) return; //skip header.
+// Dump tcp/udp/raw sockets through NETLINK_SOCK_DIAG, letting the kernel
+// skip states we won't show. Returns 0 (having shown nothing) if unsupported.
+static int diag_ip(char *label, int af, int proto)
+{
+  struct {
+    struct nlmsghdr nlh;
+    union {
+      struct inet_diag_req_v2 r;
+      struct inet_diag_req_raw raw;
+    };
+  } req;
+  struct nlmsghdr *h;
+  struct inet_diag_msg *m;
+  char *buf = 0;
+  int fd, len, shown = 0;
+
+  fd = socket(AF_NETLINK, SOCK_DGRAM|SOCK_CLOEXEC, NETLINK_SOCK_DIAG);
+  if (fd == -1) return 0;
+
+  memset(&req, 0, sizeof(req));
+  req.nlh.nlmsg_len = sizeof(req);
+  req.nlh.nlmsg_type = SOCK_DIAG_BY_FAMILY;
+  req.nlh.nlmsg_flags = NLM_F_REQUEST|NLM_F_DUMP;
+  req.r.sdiag_family = af;
+  req.r.sdiag_protocol = proto;
+  req.r.idiag_states = ~0;
+  // raw_diag only dumps sockets of the requested protocol, IPPROTO_RAW is all
+  if (proto == IPPROTO_RAW) req.raw.sdiag_raw_protocol = IPPROTO_RAW;
+  // tcp servers are LISTEN (or an unconnected CLOSE), so -lt never sees
+  // the established/TIME_WAIT hordes and plain -t never sees listeners.
+  if (proto == IPPROTO_TCP && !(toys.optflags & FLAG_a)) {
+    if (toys.optflags & FLAG_l) req.r.idiag_states = (1<<10)|(1<<7);
+    else req.r.idiag_states &= ~(1<<10);
+  }
+  if (send(fd, &req, sizeof(req), 0) != sizeof(req)) goto done;
+
+  buf = xmalloc(32768);
+  while (0<(len = recv(fd, buf, 32768, 0))) {
+    for (h = (void *)buf; NLMSG_OK(h, len); h = NLMSG_NEXT(h, len)) {
+      // A dump this kernel can't do (no raw_diag, say) ends with an errno
+      if (h->nlmsg_type == NLMSG_DONE) shown |= *(int *)NLMSG_DATA(h) >= 0;
+      if (h->nlmsg_type == NLMSG_DONE || h->nlmsg_type == NLMSG_ERROR)
+        goto done;
+      m = NLMSG_DATA(h);
+
+      // /proc shows send queue 0 for listeners, diag shows the backlog limit
+      show_ip_sock(label, af, m->id.idiag_src, ntohs(m->id.idiag_sport),
+        m->id.idiag_dst, ntohs(m->id.idiag_dport), m->idiag_state,
+        m->idiag_state == 10 ? 0 : m->idiag_wqueue, m->idiag_rqueue,
+        m->idiag_uid, m->idiag_inode);
+      shown = 1;
+    }
+  }
+
+done:
+  free(buf);
+  close(fd);
+
+  return shown;
+}
+
+// Display info for tcp/udp/raw from /proc/net/$label
+static void show_ip(char *label, int af, int proto)
+{
+  char *fname = xmprintf("/proc/net/%s", label);
+  FILE *fp;
+
+  if (diag_ip(label, af, proto)) goto done;
+  if (!(fp = fopen(fname, "r"))) {
+    perror_msg("'%s'", fname);
+    goto done;
+  }
+
+  if (!fgets(toybuf, sizeof(toybuf), fp)) goto close; //skip header.
 
   while (fgets(toybuf, sizeof(toybuf), fp)) {
-    char lip[256], rip[256];
     union {
       struct {unsigned u; unsigned char b[4];} i4;
       struct {struct {unsigned a, b, c, d;} u; unsigned char b[16];} i6;
@@ -144,41 +250,13 @@ static void show_ip(char *fname)
       nitems = AF_INET;
     } else nitems = AF_INET6;
 
-    // Should we display this? (listening or all or TCP/UDP/RAW)
-    if (!((toys.optflags & FLAG_l) && (!rport && (state & 0xA)))
-      && !(toys.optflags & FLAG_a) && !(rport & (0x10 | 0x20 | 0x40)))
-        continue;
-
-    addr2str(nitems, &laddr, lport, lip, TT.wpad, label);
-    addr2str(nitems, &raddr, rport, rip, TT.wpad, label);
-
-    // Display data
-    s = label;
-    if (strstart(&s, "tcp")) {
-      int sz = ARRAY_LEN(state_label);
-      if (!state || state >= sz) state = sz-1;
-      ss_state = state_label[state];
-    } else if (strstart(&s, "udp")) {
-      if (state == 1) ss_state = state_label[state];
-      else if (state == 7) ss_state = "";
-    } else if (strstart(&s, "raw")) sprintf(ss_state = buf, "%u", state);
-
-    if (!(toys.optflags & FLAG_n) && (pw = bufgetpwuid(uid)))
-      snprintf(toybuf, sizeof(toybuf), "%s", pw->pw_name);
-    else snprintf(toybuf, sizeof(toybuf), "%d", uid);
-
-    printf("%-6s%6d%7d ", label, rxq, txq);
-    printf("%*.*s %*.*s ", -TT.wpad, TT.wpad, lip, -TT.wpad, TT.wpad, rip);
-    printf("%-11s", ss_state);
-    if ((toys.optflags & FLAG_e)) printf(" %-10s %-11ld", toybuf, inode);
-    if ((toys.optflags & FLAG_p)) {
-      struct num_cache *nc = get_num_cache(TT.inodes, inode);
-
-      printf(" %s", nc ? nc->data : "-");
-    }
-    xputc('\n');
+    show_ip_sock(label, nitems, &laddr, lport, &raddr, rport, state, txq, rxq,
+      uid, inode);
   }
+close:
   fclose(fp);
+done:
+  free(fname);
 }
 
 static void show_unix_sockets(void)
@@ -214,7 +292,7 @@ static void show_unix_sockets(void)
     printf("unix  %-6ld %-11s %-10s %-13s %8lu ",
       refcount, toybuf, types[type], states[state], inode);
     if (toys.optflags & FLAG_p) {
-      struct num_cache *nc = get_num_cache(TT.inodes, inode);
+      struct num_cache *nc = get_num_hash(&TT.inodes, inode);
 
       printf("%-19.19s", nc ? nc->data : "-");
     }
@@ -223,7 +301,7 @@ static void show_unix_sockets(void)
       if ((ss = strrchr(s = toybuf+offset, '\n'))) *ss = 0;
       printf("%s", s);
     }
-    xputc('\n');
+    putchar('\n');
   }
 
   fclose(fp);
@@ -258,7 +336,7 @@ static int scan_pids(struct dirtree *node)
       long long ll = atoll(s);
 
       sprintf(s, "%d/%s", pid, getbasename(toybuf));
-      add_num_cache(&TT.inodes, ll, s, strlen(s)+1);
+      add_num_hash(&TT.inodes, ll, s, strlen(s)+1);
     }
   }
   closedir(dp);
@@ -356,16 +434,16 @@ void netstat_main(void)
     xputc('\n');
 
     if (toys.optflags & FLAG_t) {
-      show_ip("/proc/net/tcp");
-      show_ip("/proc/net/tcp6");
+      show_ip("tcp", AF_INET, IPPROTO_TCP);
+      show_ip("tcp6", AF_INET6, IPPROTO_TCP);
     }
     if (toys.optflags & FLAG_u) {
-      show_ip("/proc/net/udp");
-      show_ip("/proc/net/udp6");
+      show_ip("udp", AF_INET, IPPROTO_UDP);
+      show_ip("udp6", AF_INET6, IPPROTO_UDP);
     }
     if (toys.optflags & FLAG_w) {
-      show_ip("/proc/net/raw");
-      show_ip("/proc/net/raw6");
+      show_ip("raw", AF_INET, IPPROTO_RAW);
+      show_ip("raw6", AF_INET6, IPPROTO_RAW);
     }
   }
 
@@ -377,7 +455,8 @@ void netstat_main(void)
     show_unix_sockets();
   }
 
+  xflush();
   if ((toys.optflags & FLAG_p) && CFG_TOYBOX_FREE)
-    llist_traverse(TT.inodes, free);
+    free_num_hash(&TT.inodes);
   toys.exitval = 0;
 }
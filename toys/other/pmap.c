@@ -5,16 +5,18 @@
  *
  * No Standard.
 
-USE_PMAP(NEWTOY(pmap, "<1xq", TOYFLAG_BIN))
+USE_PMAP(NEWTOY(pmap, "<1j#<1xqs", TOYFLAG_BIN))
 
 config PMAP
   bool "pmap"
   default y
   help
-    usage: pmap [-xq] [pids...]
+    usage: pmap [-sxq] [-j JOBS] [pids...]
 
     Reports the memory map of a process or processes.
 
+    -j Read JOBS processes in parallel (output stays in pid order).
+    -s Summary: only show the total line.
     -x Show the extended format.
     -q Do not display some header/footer lines.
 */
@@ -22,92 +24,118 @@ config PMAP
 #define FOR_pmap
 #include "toys.h"
 
-void pmap_main(void)
+GLOBALS(
+  long j;
+)
+
+static void pmap_pid(pid_t pid)
 {
-  char **optargs;
-
-  for (optargs = toys.optargs; *optargs; optargs++) {
-    pid_t pid = atolx(*optargs);
-    FILE *fp;
-    char *line, *oldline = 0, *name = 0,
-         *k = (toys.optflags & FLAG_x) ? "" : "K";
-    size_t len;
-    long long start, end, pss, tpss = 0, dirty, tdirty = 0, swap, tswap = 0,
-              total = 0;
-    int xx = 0;
-
-    snprintf(toybuf, sizeof(toybuf), "/proc/%u/cmdline", pid);
-    line = readfile(toybuf, 0, 0);
-    if (!line) error_msg("No %lu", (long)pid);
-    xprintf("%u: %s\n", (int)pid, line);
-    free(line);
-
-    // Header
-    // Only use the more verbose file in -x mode
-    sprintf(toybuf, "/proc/%u/%smaps", pid,
-      (toys.optflags & FLAG_x) ? "s" : "");
-    if (!(fp = fopen(toybuf, "r"))) {
-      error_msg("No %ld\n", (long)pid);
-      return;
+  FILE *fp;
+  char *line = 0, *name = toybuf+16, *s,
+       *k = (toys.optflags & FLAG_x) ? "" : "K";
+  size_t len = 0;
+  long long start, end, pss = 0, tpss = 0, dirty = 0, tdirty = 0, swap = 0,
+            tswap = 0, total = 0;
+  int x = !!(toys.optflags & FLAG_x), show = !(toys.optflags & FLAG_s),
+      pending = 0, rollup = 0, i;
+
+  snprintf(toybuf, sizeof(toybuf), "/proc/%u/cmdline", pid);
+  line = readfile(toybuf, 0, 0);
+  if (!line) error_msg("No %lu", (long)pid);
+  printf("%u: %s\n", (int)pid, line);
+  free(line);
+  line = 0;
+
+  // A -x summary can get the kernel's sum of the smaps fields from
+  // smaps_rollup and the sizes from the much shorter maps.
+  if (x && !show) {
+    snprintf(toybuf, sizeof(toybuf), "/proc/%u/smaps_rollup", pid);
+    if (readfile(toybuf, toybuf, sizeof(toybuf))) {
+      if ((s = strafter(toybuf, "\nPss:"))) tpss = atoll(s);
+      if ((s = strafter(toybuf, "\nPrivate_Dirty:"))) tdirty = atoll(s);
+      if ((s = strafter(toybuf, "\nSwap:"))) tswap = atoll(s);
+      rollup = 1;
     }
+  }
 
-    if ((toys.optflags & (FLAG_q|FLAG_x)) == FLAG_x)
-      xprintf("Address%*cKbytes     PSS   Dirty    Swap  Mode  Mapping\n",
-        (int)(sizeof(long)*2)-4, ' ');
-
-    // Loop through mappings
-    for (;;) {
-      int off, count;
-
-      line = 0;
-      if (0 >= getline(&line, &len, fp)) break;
-      count = sscanf(line, "%llx-%llx %s %*s %*s %*s %n",
-        &start, &end, toybuf, &off);
-
-      if (count == 3) {
-        name = line[off] ? line+off : "  [anon]\n";
-        if (toybuf[3] == 'p') toybuf[3] = '-';
-        total += end = (end-start)/1024;
-        printf("%0*llx % *lld%s ", (int)(2*sizeof(long)), start,
-          6+!!(toys.optflags & FLAG_x), end, k);
-        if (toys.optflags & FLAG_x) {
-          oldline = line;
-          continue;
-        }
-      } else {
-        if (0<sscanf(line, "Pss: %lld", &pss)
-            || 0<sscanf(line, "Private_Dirty: %lld", &dirty)
-            || 0<sscanf(line, "Swap: %lld", &swap)) xx++;
-        free(line);
-        if (xx<3) continue;
-        line = oldline;
-        name = basename(name);
-        xx = 0;
-        printf("% 7lld %7lld %7lld ", pss, dirty, swap);
-        tpss += pss;
-        tdirty += dirty;
-        tswap += swap;
-      }
-
-      xprintf("%s-  %s%s", toybuf, line[off]=='[' ? "  " : "", name);
-
-      free(line);
-      line = 0;
+  // Header
+  // Only use the more verbose file in -x mode
+  sprintf(toybuf, "/proc/%u/%smaps", pid, (x && !rollup) ? "s" : "");
+  if (!(fp = fopen(toybuf, "r"))) {
+    error_msg("No %ld\n", (long)pid);
+    return;
+  }
+  setvbuf(fp, 0, _IOFBF, 65536);
+
+  if (show && (toys.optflags & (FLAG_q|FLAG_x)) == FLAG_x)
+    printf("Address%*cKbytes     PSS   Dirty    Swap  Mode  Mapping\n",
+      (int)(sizeof(long)*2)-4, ' ');
+
+  // Loop through mappings. Lines starting with a (lowercase hex) address
+  // start a new mapping, smaps follows each with "Key: value" lines.
+  for (;;) {
+    i = getline(&line, &len, fp);
+    if (pending && (i<1 || isdigit(*line) || (*line>='a' && *line<='f'))) {
+      if (show) printf("% 7lld %7lld %7lld %s-  %s", pss, dirty, swap, toybuf,
+        name);
+      tpss += pss;
+      tdirty += dirty;
+      tswap += swap;
+      pending = 0;
     }
-
-    // Trailer
-    if (!(toys.optflags & FLAG_q)) {
-      int x = !!(toys.optflags & FLAG_x);
-      if (x) {
-        memset(toybuf, '-', 16);
-        xprintf("%.*s  ------  ------  ------  ------\n", (int)(sizeof(long)*2),
-          toybuf);
+    if (i<1) break;
+
+    if (isdigit(*line) || (*line>='a' && *line<='f')) {
+      start = strtoull(line, &s, 16);
+      end = strtoull(s+1, &s, 16);
+      for (s++, i = 0; i<4 && *s && *s!=' '; i++) toybuf[i] = *s++;
+      toybuf[i] = 0;
+      if (toybuf[3] == 'p') toybuf[3] = '-';
+      for (i = 0; i<3; i++) {
+        s += strspn(s, " ");
+        s += strcspn(s, " ");
       }
-      printf("total% *lld%s", 2*(int)(sizeof(long)+1)+x, total, k);
-      if (x) printf("% 8lld% 8lld% 8lld", tpss, tdirty, tswap);
-      xputc('\n');
+      s += strspn(s, " \n");
+      snprintf(name, sizeof(toybuf)-16, "%s%s", *s=='[' ? "  " : "",
+        *s ? (x ? basename(s) : s) : "  [anon]\n");
+      total += end = (end-start)/1024;
+      if (show) printf("%0*llx % *lld%s ", (int)(2*sizeof(long)), start, 6+x,
+        end, k);
+      if (x) pending = 1;
+      else if (show) printf("%s-  %s", toybuf, name);
+      pss = dirty = swap = 0;
+    } else if (x) {
+      // Only three keys matter, dispatch on the first letter.
+      s = line;
+      if (*s == 'P') {
+        if (strstart(&s, "Pss:")) pss = atoll(s);
+        else if (strstart(&s, "Private_Dirty:")) dirty = atoll(s);
+      } else if (*s == 'S' && strstart(&s, "Swap:")) swap = atoll(s);
+    }
+  }
+  fclose(fp);
+  free(line);
+
+  if (!(toys.optflags & FLAG_q)) {
+    if (x) {
+      memset(toybuf, '-', 16);
+      printf("%.*s  ------  ------  ------  ------\n", (int)(sizeof(long)*2),
+        toybuf);
     }
- 
-    fclose(fp);
+    printf("total% *lld%s", 2*(int)(sizeof(long)+1)+x, total, k);
+    if (x) printf("% 8lld% 8lld% 8lld", tpss, tdirty, tswap);
+    putchar('\n');
   }
 }
+
+void pmap_main(void)
+{
+  pid_t *pids = xmalloc(toys.optc*sizeof(pid_t));
+  int i;
+
+  for (i = 0; i<toys.optc; i++) pids[i] = atolx(toys.optargs[i]);
+  pids_parallel((toys.optflags & FLAG_j) ? TT.j : 1, pids, toys.optc, pmap_pid,
+    0);
+  xflush();
+  if (CFG_TOYBOX_FREE) free(pids);
+}
@@ -15,32 +15,75 @@ config TAC
 
 #include "toys.h"
 
+// Seekable files are read backwards a block at a time so we never hold
+// more than the current line plus one block. Anything else is read in whole,
+// as are files whose size turns out to be a lie (sysfs says 4096 for all).
 static void do_tac(int fd, char *name)
 {
-  struct arg_list *list = NULL;
-  char *c;
+  off_t start = lseek(fd, 0, SEEK_CUR), pos = lseek(fd, 0, SEEK_END);
+  long off = 0, len = 0, size = 0, unseen, chunk, got;
+  char *buf = 0, *s;
+  int out = 0;
 
-  // Read in lines
-  for (;;) {
-    struct arg_list *temp;
-    long len;
+  if (pos <= start) {
+slurp:
+    if (start >= 0) lseek(fd, pos = start, SEEK_SET);
+    for (off = 0;;) {
+      if (len == size) buf = xrealloc(buf, size += 65536);
+      if (1 > (chunk = read(fd, buf+len, size-len))) {
+        if (chunk) perror_msg_raw(name);
 
-    if (!(c = get_rawline(fd, &len, '\n'))) break;
-
-    temp = xmalloc(sizeof(struct arg_list));
-    temp->next = list;
-    temp->arg = c;
-    list = temp;
+        break;
+      }
+      len += chunk;
+    }
   }
 
-  // Play them back.
-  while (list) {
-    struct arg_list *temp = list->next;
-    xprintf("%s", list->arg);
-    free(list->arg);
-    free(list);
-    list = temp;
+  // Data is the len bytes at buf+off, the first unseen of which haven't been
+  // searched for newlines yet. Never go back past where the caller left a
+  // shared stdin.
+  for (unseen = len; len || pos > start;) {
+    s = unseen ? memrchr(buf+off, '\n', unseen<len ? unseen : len-1) : 0;
+    unseen = 0;
+
+    // Output last line once we've found where it starts
+    if (s || pos <= start) {
+      chunk = s ? s+1-(buf+off) : 0;
+      fwrite(buf+off+chunk, len-chunk, 1, stdout);
+      unseen = len = chunk;
+      out++;
+
+    // Prepend previous block of file, growing the buffer downward. Data only
+    // moves when the space in front runs out, after which there's room for
+    // at least as much again, so long lines don't cost O(n^2).
+    } else {
+      chunk = pos-start < 65536 ? pos-start : 65536;
+      if (off < chunk) {
+        if (size < (got = 2*(len+chunk))) {
+          s = xmalloc(got);
+          memcpy(s+got-len, buf+off, len);
+          free(buf);
+          buf = s;
+          size = got;
+        } else memmove(buf+size-len, buf+off, len);
+        off = size-len;
+      }
+      off -= chunk;
+      pos -= chunk;
+      if (chunk != (got = pread(fd, buf+off, chunk, pos))) {
+        if (got < 0) perror_msg_raw(name);
+        else if (!out) {
+          len = 0;
+          goto slurp;
+        } else error_msg("%s: short read", name);
+
+        break;
+      }
+      unseen = chunk;
+      len += chunk;
+    }
   }
+  free(buf);
 }
 
 void tac_main(void)
@@ -5,15 +5,16 @@
  * TODO: I have no idea how "system" category is calculated.
  * whatever we're doing isn't matching what other implementations are doing.
 
-USE_VMSTAT(NEWTOY(vmstat, ">2n", TOYFLAG_BIN))
+USE_VMSTAT(NEWTOY(vmstat, ">2nC", TOYFLAG_BIN))
 
 config VMSTAT
   bool "vmstat"
   default y
   help
-    usage: vmstat [-n] [DELAY [COUNT]]
+    usage: vmstat [-nC] [DELAY [COUNT]]
 
     Print virtual memory statistics, repeating each DELAY seconds, COUNT times.
+    (DELAY can be fractional, ala "0.01".)
     (With no DELAY, prints one line. With no COUNT, repeats until killed.)
 
     Show processes running and blocked, kilobytes swapped, free, buffered, and
@@ -23,11 +24,17 @@ config VMSTAT
     First line is since system started, later lines are since last line.
 
     -n	Display the header only once
+    -C	Comma separated output, each line starting with milliseconds elapsed
 */
 
 #define FOR_vmstat
 #include "toys.h"
 
+GLOBALS(
+  struct reread files[3];
+  unsigned hints[23];
+)
+
 struct vmstat_proc {
   // From /proc/stat (jiffies)
   uint64_t user, nice, sys, idle, wait, irq, sirq, intr, ctxt, running, blocked;
@@ -40,7 +47,8 @@ struct vmstat_proc {
 };
 
 // All the elements of vmstat_proc are the same size, so we can populate it as
-// a big array, then read the elements back out by name
+// a big array, then read the elements back out by name. The files stay open
+// between samples, and each key is looked for where it was found last time.
 static void get_vmstat_proc(struct vmstat_proc *vmstat_proc)
 {
   char *vmstuff[] = { "/proc/stat", "cpu ", 0, 0, 0, 0, 0, 0,
@@ -48,8 +56,9 @@ static void get_vmstat_proc(struct vmstat_proc *vmstat_proc)
     "MemFree: ", "Buffers: ", "Cached: ", "SwapFree: ", "SwapTotal: ",
     "/proc/vmstat", "pgpgin ", "pgpgout ", "pswpin ", "pswpout " };
   uint64_t *new = (uint64_t *)vmstat_proc;
-  char *p = p, *name = name;
-  int i, j;
+  struct reread *rr = TT.files-1;
+  char *p = p, *name = name, *end;
+  int i;
 
   // We use vmstuff to fill out vmstat_proc as an array of uint64_t:
   //   Strings starting with / are the file to find next entries in
@@ -59,12 +68,13 @@ static void get_vmstat_proc(struct vmstat_proc *vmstat_proc)
   for (i = 0; i<sizeof(vmstuff)/sizeof(char *); i++) {
     if (!vmstuff[i]) p++;
     else if (*vmstuff[i] == '/') {
-      xreadfile(name = vmstuff[i], toybuf, sizeof(toybuf));
+      if (!reread(++rr, name = vmstuff[i])) perror_exit("%s", name);
 
       continue;
-    } else if (!(p = strafter(toybuf, vmstuff[i]))) goto error;
-    if (1 != sscanf(p, "%"PRIu64"%n", new++, &j)) goto error;
-    p += j;
+    } else if (!(p = reread_key(rr, vmstuff[i], TT.hints+i))) goto error;
+    *new++ = strtoull(p, &end, 10);
+    if (end == p) goto error;
+    p = end;
   }
 
   return;
@@ -76,22 +86,32 @@ error:
 void vmstat_main(void)
 {
   struct vmstat_proc top[2];
-  int i, loop_delay = 0, loop_max = 0;
-  unsigned loop, rows = (toys.optflags & FLAG_n) ? 0 : 25,
+  struct timespec ts;
+  long long now, then = 0, first = 0;
+  long i, loop_delay = 0, loop_max = 0;
+  unsigned loop, rows = (toys.optflags & (FLAG_n|FLAG_C)) ? 0 : 25,
            page_kb = sysconf(_SC_PAGESIZE)/1024;
   char *headers="r\0b\0swpd\0free\0buff\0cache\0si\0so\0bi\0bo\0in\0cs\0us\0"
                 "sy\0id\0wa", lengths[] = {2,2,6,6,6,6,4,4,5,5,4,4,2,2,2,2};
 
   memset(top, 0, sizeof(top));
-  if (toys.optc) loop_delay = atolx_range(toys.optargs[0], 0, INT_MAX);
+  // Delay is in milliseconds
+  if (toys.optc) {
+    loop_delay = xparsetime(toys.optargs[0], 1000, &i);
+    if (loop_delay > INT_MAX/1000) error_exit("bad delay");
+    loop_delay = loop_delay*1000+i;
+  }
   if (toys.optc > 1) loop_max = atolx_range(toys.optargs[1], 1, INT_MAX) - 1;
 
+  if (toys.optflags & FLAG_C)
+    xputs("ms,r,b,swpd,free,buff,cache,si,so,bi,bo,in,cs,us,sy,id,wa");
+
   for (loop = 0; !loop_max || loop <= loop_max; loop++) {
     unsigned idx = loop&1, offset = 0, expected = 0;
     uint64_t units, total_hz, *ptr = (uint64_t *)(top+idx),
              *oldptr = (uint64_t *)(top+!idx);
 
-    if (loop && loop_delay) sleep(loop_delay);
+    if (loop && loop_delay) msleep(loop_delay);
 
     // Print headers
     if (rows>3 && !(loop % (rows-3))) {
@@ -110,6 +130,8 @@ void vmstat_main(void)
 
     // Read data and combine some fields we display as aggregates
     get_vmstat_proc(top+idx);
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    now = ts.tv_sec*1000000LL+ts.tv_nsec/1000;
     top[idx].running--; // Don't include ourselves
     top[idx].user += top[idx].nice;
     top[idx].sys += top[idx].irq + top[idx].sirq;
@@ -122,13 +144,20 @@ void vmstat_main(void)
 
       xreadfile("/proc/uptime", toybuf, sizeof(toybuf));
       while (*(s++) > ' ');
-      sscanf(s, "%"PRIu64, &units);
-    } else units = loop_delay;
+      units = strtoull(s, 0, 10)*1000000;
+      first = now;
+
+    // Rates are over the time that really passed, not the nominal delay
+    } else if (!(units = now-then)) units = 1;
+    then = now;
 
     // add up user, sys, idle, and wait time used since last time
     // (Already appended nice to user)
     total_hz = 0;
     for (i=0; i<4; i++) total_hz += ptr[i+!!i] - oldptr[i+!!i];
+    if (!total_hz) total_hz = 1;
+
+    if (toys.optflags & FLAG_C) printf("%lld", (now-first)/1000);
 
     // Output values in order[]: running, blocked, swaptotal, memfree, buffers,
     // cache, swap_in, swap_out, io_in, io_out, sirq, ctxt, user, sys, idle,wait
@@ -138,12 +167,17 @@ void vmstat_main(void)
       uint64_t out = ptr[order[i]];
       int len;
 
-      // Adjust rate and units
+      // Adjust rate and units (units is microseconds, rates are per second)
       if (i>5) out -= oldptr[order[i]];
       if (order[i]<7) out = ((out*100) + (total_hz/2)) / total_hz;
-      else if (order[i]>17) out = ((out * page_kb)+(units-1))/units;
-      else if (order[i]>15) out = ((out)+(units-1))/units;
-      else if (order[i]<9) out = (out+(units-1)) / units;
+      else if (order[i]>17) out = ((out*page_kb*1000000)+(units-1))/units;
+      else if (order[i]>15) out = ((out*1000000)+(units-1))/units;
+      else if (order[i]<9) out = (out*1000000+(units-1)) / units;
+
+      if (toys.optflags & FLAG_C) {
+        printf(",%"PRIu64, out);
+        continue;
+      }
 
       // If a field was too big to fit in its slot, try to compensate later
       expected += lengths[i] + !!i;
@@ -32,13 +32,18 @@ GLOBALS(
   long g;
   long l;
   long c;
+
+  char hex[512];
+  signed char unhex[256];
 )
 
 static void do_xxd(int fd, char *name)
 {
   long long pos = 0;
   long long limit = TT.l;
-  int i, len, space;
+  int i, j, len, space, plain = toys.optflags&FLAG_p,
+    block = TT.c*(65536/TT.c);
+  char *in = xmalloc(block), *out = xmalloc(65536+32+4*TT.c), *o = out, *line;
 
   if (toys.optflags&FLAG_s) {
     xlseek(fd, TT.s, SEEK_SET);
@@ -46,93 +51,108 @@ static void do_xxd(int fd, char *name)
     if (limit) limit += TT.s;
   }
 
-  while (0<(len = readall(fd, toybuf,
-                          (limit && limit-pos<TT.c)?limit-pos:TT.c))) {
-    if (!(toys.optflags&FLAG_p)) printf("%08llx: ", pos);
-    pos += len;
-    space = 2*TT.c+TT.c/TT.g+1;
-
-    for (i=0; i<len;) {
-      space -= printf("%02x", toybuf[i]);
-      if (!(++i%TT.g)) {
-        putchar(' ');
-        space--;
+  // Read many lines at a time, and format each line with table lookups.
+  while (0<(len = readall(fd, in, (limit && limit-pos<block)?limit-pos:block)))
+  {
+    for (line = in; line<in+len; line += TT.c) {
+      int n = (in+len-line<TT.c) ? in+len-line : TT.c;
+
+      if (!plain) {
+        if (pos>>32) o += sprintf(o, "%08llx", pos);
+        else for (i = 8; i--;) *o++ = TT.hex[2*((pos>>(4*i))&15)+1];
+        *o++ = ':';
+        *o++ = ' ';
+      }
+      pos += n;
+      space = 2*TT.c+TT.c/TT.g+1;
+
+      for (i = 0, j = TT.g; i<n; i++) {
+        memcpy(o, TT.hex+2*line[i], 2);
+        o += 2;
+        space -= 2;
+        if (!--j) {
+          *o++ = ' ';
+          space--;
+          j = TT.g;
+        }
       }
-    }
 
-    if (!(toys.optflags&FLAG_p)) {
-      printf("%*s", space, "");
-      for (i=0; i<len; i++)
-        putchar((toybuf[i]>=' ' && toybuf[i]<='~') ? toybuf[i] : '.');
+      if (!plain) {
+        memset(o, ' ', space);
+        o += space;
+        for (i=0; i<n; i++)
+          *o++ = (line[i]>=' ' && line[i]<='~') ? line[i] : '.';
+      }
+      *o++ = '\n';
+      if (o-out>=65536) {
+        xwrite(1, out, o-out);
+        o = out;
+      }
     }
-    putchar('\n');
   }
+  xwrite(1, out, o-out);
   if (len<0) perror_exit("read");
+  free(in);
+  free(out);
 }
-
-static int dehex(char ch)
-{
-  if (ch >= '0' && ch <= '9') return ch - '0';
-  if (ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
-  if (ch >= 'A' && ch <= 'F') return ch - 'a' + 10;
-  return (ch == '\n') ? -2 : -1;
-}
-
 static void do_xxd_reverse(int fd, char *name)
 {
   FILE *fp = xfdopen(fd, "r");
+  char *line = 0, *s, *o;
+  size_t size = 0;
+  int n1, n2, col;
 
-  while (!feof(fp)) {
-    int col = 0;
-    int tmp;
+  // Decode each line in place: output is never longer than its hex input.
+  while (0<getline(&line, &size, fp)) {
+    s = line;
 
     // Each line of a non-plain hexdump starts with an offset/address.
     if (!(toys.optflags&FLAG_p)) {
-      long long pos;
+      long long pos = strtoull(s, &o, 16);
 
-      if (fscanf(fp, "%llx: ", &pos) == 1) {
-        if (fseek(stdout, pos, SEEK_SET) != 0) {
+      if (o != s && *o == ':') {
+        if (fseek(stdout, pos, SEEK_SET)) {
           // TODO: just write out zeros if non-seekable?
           perror_exit("%s: seek failed", name);
         }
+        for (s = o+1; isspace(*s); s++);
       }
     }
 
     // A plain hexdump can have as many bytes per line as you like,
     // but a non-plain hexdump assumes garbage after it's seen the
-    // specified number of bytes.
-    while (toys.optflags&FLAG_p || col < TT.c) {
-      int n1, n2;
-
-      // If we're at EOF or EOL or we read some non-hex...
-      if ((n1 = n2 = dehex(fgetc(fp))) < 0 || (n2 = dehex(fgetc(fp))) < 0) {
-        // If we're at EOL, start on that line.
-        if (n1 == -2 || n2 == -2) continue;
-        // Otherwise, skip to the next line.
-        break;
-      }
-
-      fputc((n1 << 4) | (n2 & 0xf), stdout);
-      col++;
+    // specified number of bytes. Stop at the first non-hex (such as the
+    // ASCII dump, or EOL).
+    for (o = line, col = 0; toys.optflags&FLAG_p || col < TT.c; col++) {
+      if ((n1 = TT.unhex[s[0]])<0 || (n2 = TT.unhex[s[1]])<0) break;
+      *o++ = (n1<<4)|n2;
 
       // Is there any grouping going on? Ignore a single space.
-      tmp = fgetc(fp);
-      if (tmp != ' ') ungetc(tmp, fp);
+      if (*(s += 2) == ' ') s++;
     }
-
-    // Skip anything else on this line (such as the ASCII dump).
-    while ((tmp = fgetc(fp)) != EOF && tmp != '\n')
-      ;
+    fwrite(line, 1, o-line, stdout);
   }
   if (ferror(fp)) perror_msg_raw(name);
 
   fclose(fp);
+  free(line);
 }
 
 void xxd_main(void)
 {
+  int i;
+
   // Plain style is 30 bytes/line, no grouping.
   if (toys.optflags&FLAG_p) TT.c = TT.g = 30;
 
+  // Lookup tables for both directions.
+  memset(TT.unhex, -1, 256);
+  for (i = 0; i<256; i++) {
+    TT.hex[2*i] = "0123456789abcdef"[i>>4];
+    TT.hex[2*i+1] = "0123456789abcdef"[i&15];
+    if (i<16) TT.unhex[TT.hex[2*i+1]] = TT.unhex[toupper(TT.hex[2*i+1])] = i;
+  }
+
   loopfiles(toys.optargs, toys.optflags&FLAG_r ? do_xxd_reverse : do_xxd);
+  xflush();
 }
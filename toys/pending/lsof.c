@@ -2,17 +2,18 @@
  *
  * Copyright 2015 The Android Open Source Project
 
-USE_LSOF(NEWTOY(lsof, "lp*t", TOYFLAG_USR|TOYFLAG_BIN))
+USE_LSOF(NEWTOY(lsof, "j#<1lp*t", TOYFLAG_USR|TOYFLAG_BIN))
 
 config LSOF
   bool "lsof"
   default n
   help
-    usage: lsof [-lt] [-p PID1,PID2,...] [NAME]...
+    usage: lsof [-lt] [-j JOBS] [-p PID1,PID2,...] [NAME]...
 
     Lists open files. If names are given on the command line, only
     those files will be shown.
 
+    -j	scan all pids with JOBS parallel worker processes
     -l	list uids numerically
     -p	for given comma-separated pids only (default all pids)
     -t	terse (pid only) output
@@ -23,13 +24,14 @@ config LSOF
 
 GLOBALS(
   struct arg_list *p;
+  long j;
 
   struct stat *sought_files;
 
-  struct double_list *all_sockets;
+  struct num_hash sockets;
   struct double_list *files;
   int last_shown_pid;
-  int shown_header;
+  int shown_header, scanned_sockets;
 )
 
 struct proc_info {
@@ -51,6 +53,12 @@ struct file_info {
   ino_t st_ino;
 };
 
+static char *header(void)
+{
+  return xmprintf("%-9s %5s %10.10s %4s   %7s %18s %9s %10s %s", "COMMAND",
+    "PID", "USER", "FD", "TYPE", "DEVICE", "SIZE/OFF", "NODE", "NAME");
+}
+
 static void print_info(void *data)
 {
   struct file_info *fi = data;
@@ -72,8 +80,10 @@ static void print_info(void *data)
   } else {
     if (!TT.shown_header) {
       // TODO: llist_traverse to measure the columns first.
-      printf("%-9s %5s %10.10s %4s   %7s %18s %9s %10s %s\n", "COMMAND", "PID",
-        "USER", "FD", "TYPE", "DEVICE", "SIZE/OFF", "NODE", "NAME");
+      char *s = header();
+
+      puts(s);
+      free(s);
       TT.shown_header = 1;
     }
 
@@ -130,14 +140,14 @@ static void scan_proc_net_file(char *path, int family, char type,
   fclose(fp);
 }
 
-static struct file_info *add_socket(ino_t inode, const char *type)
+// Index sockets by inode, data is "type\0name\0". First one seen wins.
+static void add_socket(ino_t inode, char *type, char *name)
 {
-  struct file_info *fi = xzalloc(sizeof(struct file_info));
+  int len = strlen(type)+1;
+  char *s = xmprintf("%s%c%s", type, 0, name);
 
-  dlist_add_nomalloc(&TT.all_sockets, (struct double_list *)fi);
-  fi->st_ino = inode;
-  strcpy(fi->type, type);
-  return fi;
+  add_num_hash(&TT.sockets, inode, s, len+strlen(name)+1);
+  free(s);
 }
 
 static void scan_unix(char *line, int af, char type)
@@ -146,10 +156,9 @@ static void scan_unix(char *line, int af, char type)
   int path_pos;
 
   if (sscanf(line, "%*p: %*X %*X %*X %*X %*X %lu %n", &inode, &path_pos) >= 1) {
-    struct file_info *fi = add_socket(inode, "unix");
     char *name = chomp(line + path_pos);
 
-    fi->name = strdup(*name ? name : "socket");
+    add_socket(inode, "unix", *name ? name : "socket");
   }
 }
 
@@ -169,9 +178,8 @@ static void scan_netlink(char *line, int af, char type)
     return;
   }
 
-  struct file_info *fi = add_socket(inode, "netlink");
-  fi->name =
-      strdup(state < ARRAY_LEN(netlink_states) ? netlink_states[state] : "?");
+  add_socket(inode, "netlink",
+    state < ARRAY_LEN(netlink_states) ? netlink_states[state] : "?");
 }
 
 static void scan_ip(char *line, int af, char type)
@@ -185,6 +193,7 @@ static void scan_ip(char *line, int af, char type)
   struct in6_addr local, remote;
   int local_port, remote_port, state;
   long inode;
+  char *name;
   int ok;
 
   if (af == 4) {
@@ -204,27 +213,27 @@ static void scan_ip(char *line, int af, char type)
   }
   if (!ok) return;
 
-  struct file_info *fi = add_socket(inode, af == 4 ? "IPv4" : "IPv6");
   inet_ntop(af, &local, local_ip, sizeof(local_ip));
   inet_ntop(af, &remote, remote_ip, sizeof(remote_ip));
   if (type == 't') {
     if (state < 0 || state > TCP_CLOSING) state = 0;
-    fi->name = xmprintf(af == 4 ?
+    name = xmprintf(af == 4 ?
                         "TCP %s:%d->%s:%d (%s)" :
                         "TCP [%s]:%d->[%s]:%d (%s)",
                         local_ip, local_port, remote_ip, remote_port,
                         tcp_states[state]);
   } else {
-    fi->name = xmprintf(af == 4 ? "%s %s:%d->%s:%d" : "%s [%s]:%d->[%s]:%d",
+    name = xmprintf(af == 4 ? "%s %s:%d->%s:%d" : "%s [%s]:%d->[%s]:%d",
                         type == 'u' ? "UDP" : "RAW",
                         local_ip, local_port, remote_ip, remote_port);
   }
+  add_socket(inode, af == 4 ? "IPv4" : "IPv6", name);
+  free(name);
 }
 
-static int find_socket(struct file_info *fi, long inode)
+static void scan_sockets(void)
 {
-  static int cached;
-  if (!cached) {
+  if (!TT.scanned_sockets) {
     scan_proc_net_file("/proc/net/tcp", 4, 't', scan_ip);
     scan_proc_net_file("/proc/net/tcp6", 6, 't', scan_ip);
     scan_proc_net_file("/proc/net/udp", 4, 'u', scan_ip);
@@ -233,22 +242,20 @@ static int find_socket(struct file_info *fi, long inode)
     scan_proc_net_file("/proc/net/raw6", 6, 'r', scan_ip);
     scan_proc_net_file("/proc/net/unix", 0, 0, scan_unix);
     scan_proc_net_file("/proc/net/netlink", 0, 0, scan_netlink);
-    cached = 1;
+    TT.scanned_sockets = 1;
   }
-  void* list = TT.all_sockets;
+}
 
-  while (list) {
-    struct file_info *s = (struct file_info*) llist_pop(&list);
+static int find_socket(struct file_info *fi, long inode)
+{
+  struct num_cache *nc;
 
-    if (s->st_ino == inode) {
-      fi->name = s->name ? strdup(s->name) : NULL;
-      strcpy(fi->type, s->type);
-      return 1;
-    }
-    if (list == TT.all_sockets) break;
-  }
+  scan_sockets();
+  if (!(nc = get_num_hash(&TT.sockets, inode))) return 0;
+  strcpy(fi->type, nc->data);
+  fi->name = xstrdup(nc->data+strlen(nc->data)+1);
 
-  return 0;
+  return 1;
 }
 
 static void fill_stat(struct file_info *fi, const char *path)
@@ -430,6 +437,15 @@ static void lsof_pid(int pid)
   visit_fds(&pi);
 }
 
+// Parallel worker: show and discard each pid's files as we go.
+static void lsof_batch(pid_t pid)
+{
+  lsof_pid(pid);
+  llist_traverse(TT.files, print_info);
+  llist_traverse(TT.files, free_info);
+  TT.files = 0;
+}
+
 static int scan_proc(struct dirtree *node)
 {
   int pid;
@@ -449,7 +465,19 @@ void lsof_main(void)
   TT.sought_files = xmalloc(toys.optc*sizeof(struct stat));
   for (i = 0; i<toys.optc; ++i) xstat(toys.optargs[i], TT.sought_files+i);
 
-  if (!TT.p) dirtree_read("/proc", scan_proc);
+  if (!TT.p && (toys.optflags&FLAG_j)) {
+    char *s = 0;
+
+    // Workers inherit the socket table rather than each parsing /proc/net,
+    // and the header is written once ahead of the first output.
+    scan_sockets();
+    if (!(toys.optflags&FLAG_t)) {
+      s = header();
+      TT.shown_header = 1;
+    }
+    pids_parallel(TT.j, 0, 0, lsof_batch, s);
+    free(s);
+  } else if (!TT.p) dirtree_read("/proc", scan_proc);
   else for (pp = TT.p; pp; pp = pp->next) {
     char *start, *end, *next = pp->arg;
     int length, pid;
@@ -466,6 +494,6 @@ void lsof_main(void)
 
   if (CFG_TOYBOX_FREE) {
     llist_traverse(TT.files, free_info);
-    llist_traverse(TT.all_sockets, free_info);
+    free_num_hash(&TT.sockets);
   }
 }
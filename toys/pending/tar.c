@@ -45,7 +45,8 @@ GLOBALS(
   struct arg_list *exc;
 
   struct arg_list *inc, *pass;
-  void *inodes, *handle;
+  void *handle;
+  struct inode_hash inodes;
 )
 
 struct tar_hdr {
@@ -71,13 +72,6 @@ struct archive_handler {
   void (*extract_handler)(struct archive_handler*);
 };
 
-struct inode_list {
-  struct inode_list *next;
-  char *arg;
-  ino_t ino;
-  dev_t dev;
-};
-
 static void copy_in_out(int src, int dst, off_t size)
 {
   int i, rd, rem = size%512, cnt;
@@ -102,26 +96,6 @@ static void itoo(char *str, int len, off_t val)
   memcpy(str, t, len);
 }
 
-static struct inode_list *seen_inode(void **list, struct stat *st, char *name)
-{
-  if (!st) llist_traverse(*list, llist_free_arg);
-  else if (!S_ISDIR(st->st_mode) && st->st_nlink > 1) {
-    struct inode_list *new;
-
-    for (new = *list; new; new = new->next)
-      if(new->ino == st->st_ino && new->dev == st->st_dev)
-        return new;
-
-    new = xzalloc(sizeof(*new));
-    new->ino = st->st_ino;
-    new->dev = st->st_dev;
-    new->arg = xstrdup(name);
-    new->next = *list;
-    *list = new;
-  }
-  return 0;
-}
-
 static void write_longname(struct archive_handler *tar, char *name, char type)
 {
   struct tar_hdr tmp;
@@ -163,7 +137,7 @@ static void add_file(struct archive_handler *tar, char **nam, struct stat *st)
   struct tar_hdr hdr;
   struct passwd *pw;
   struct group *gr;
-  struct inode_list *node;
+  struct inode_entry *node = 0;
   int i, fd =-1;
   char *c, *p, *name = *nam, *lnk, *hname, buf[512] = {0,};
   unsigned int sum = 0;
@@ -198,12 +172,14 @@ static void add_file(struct archive_handler *tar, char **nam, struct stat *st)
   itoo(hdr.mtime, sizeof(hdr.mtime), st->st_mtime);
   for (i=0; i<sizeof(hdr.chksum); i++) hdr.chksum[i] = ' ';
 
-  if ((node = seen_inode(&TT.inodes, st, hname))) {
+  if (!S_ISDIR(st->st_mode) && st->st_nlink > 1)
+    node = seen_inode(&TT.inodes, st->st_dev, st->st_ino, hname);
+  if (node) {
     //this is a hard link
     hdr.type = '1';
-    if (strlen(node->arg) > sizeof(hdr.link))
+    if (strlen(node->name) > sizeof(hdr.link))
       write_longname(tar, hname, 'K'); //write longname LINK
-    xstrncpy(hdr.link, node->arg, sizeof(hdr.link));
+    xstrncpy(hdr.link, node->name, sizeof(hdr.link));
   } else if (S_ISREG(st->st_mode)) {
     hdr.type = '0';
     if (st->st_size <= (off_t)0777777777777LL)
@@ -793,7 +769,7 @@ void tar_main(void)
     }
     memset(toybuf, 0, 1024);
     writeall(tar_hdl->src_fd, toybuf, 1024);
-    seen_inode(&TT.inodes, 0, 0);
+    if (CFG_TOYBOX_FREE) free_inode_hash(&TT.inodes);
   }
 
   if (CFG_TOYBOX_FREE) {
@@ -113,6 +113,7 @@ GLOBALS(
   uid_t uid;
   gid_t gid;
   int pflags;
+  struct inode_hash inodes;
 )
 
 struct cp_preserve {
@@ -130,6 +131,7 @@ int cp_node(struct dirtree *try)
   unsigned flags = toys.optflags;
   char *catch = try->parent ? try->name : TT.destname, *err = "%s";
   struct stat cst;
+  struct inode_entry *ie = 0;
 
   if (!dirtree_notdotdot(try)) return 0;
 
@@ -182,6 +184,19 @@ int cp_node(struct dirtree *try)
       free(s);
     }
 
+    // -a recreates hardlinks within the copy: remember where the first link
+    // to each inode went and link later ones to that.
+    if ((flags & FLAG_a) && !S_ISDIR(try->st.st_mode) && try->st.st_nlink>1) {
+      struct dirtree *top = try;
+      char *s = dirtree_path(try, 0), *dest;
+
+      while (top->parent) top = top->parent;
+      dest = xmprintf("%s%s", TT.destname, s+strlen(top->name));
+      ie = seen_inode(&TT.inodes, try->st.st_dev, try->st.st_ino, dest);
+      free(dest);
+      free(s);
+    }
+
     // Loop for -f retry after unlink
     do {
 
@@ -216,6 +231,11 @@ int cp_node(struct dirtree *try)
       } else if (flags & FLAG_l) {
         if (!linkat(tfd, try->name, cfd, catch, 0)) err = 0;
 
+      // Another link to a file we already copied
+
+      } else if (ie) {
+        if (!linkat(AT_FDCWD, ie->name, cfd, catch, 0)) err = 0;
+
       // Copy tree as symlinks. For non-absolute paths this involves
       // appending the right number of .. entries as you go down the tree.
 
@@ -435,6 +455,7 @@ void cp_main(void)
     }
     if (destdir) free(TT.destname);
   }
+  if (CFG_TOYBOX_FREE) free_inode_hash(&TT.inodes);
 }
 
 void mv_main(void)
@@ -43,6 +43,8 @@ GLOBALS(
   char *archive;
   char *pass;
   char *fmt;
+
+  struct inode_hash inodes;
 )
 
 // Read strings, tail padded to 4 byte alignment. Argument "align" is amount
@@ -151,7 +153,21 @@ void cpio_main(void)
       if (!err && !geteuid() && !(toys.optflags & FLAG_no_preserve_owner))
         err = lchown(name, uid, gid);
     } else if (S_ISREG(mode)) {
-      int fd = test ? 0 : open(name, O_CREAT|O_WRONLY|O_TRUNC|O_NOFOLLOW, mode);
+      struct inode_entry *ie = 0;
+      int fd;
+
+      // Hardlinks share dev+ino: link to the first one we extracted, then
+      // write this record's data (if any) through the new link. Only one
+      // record of the set need carry the data, so don't truncate without it.
+      if (!test && x8u(toybuf+38) > 1)
+        ie = seen_inode(&TT.inodes, dev_makedev(x8u(toybuf+62),
+          x8u(toybuf+70)), x8u(toybuf+6), name);
+      if (ie) {
+        unlink(name);
+        if (link(ie->name, name)) perror_msg("link '%s'", name);
+      }
+      fd = test ? 0 : open(name, O_CREAT|O_WRONLY|O_NOFOLLOW
+        |(ie && !size ? 0 : O_TRUNC), mode);
 
       // If write fails, we still need to read/discard data to continue with
       // archive. Since doing so overwrites errno, report error now
@@ -280,6 +296,7 @@ void cpio_main(void)
       sprintf(toybuf, "070701%040X%056X%08XTRAILER!!!", 1, 0x0b, 0)+4);
   }
   if (TT.archive) xclose(afd);
+  if (CFG_TOYBOX_FREE) free_inode_hash(&TT.inodes);
 
   if (TT.pass) toys.exitval |= xpclose(pid, pipe);
 }
@@ -35,7 +35,7 @@ GLOBALS(
 
   void *slist_head;
   unsigned nelem;
-  void (*do_cut)(int fd);
+  void (*do_cut)(char *line, long len);
 )
 
 struct slist {
@@ -89,7 +89,8 @@ static void parse_list(char *list)
       end = atolx_range(ctoken, 0, INT_MAX);
       if (!end) end = INT_MAX;
       end--;
-      if(end == start) end = -1;
+      if (end < start) error_exit("invalid decreasing range");
+      if (end == start) end = -1;
     }
     add_to_list(start, end);
     TT.nelem++;
@@ -98,132 +99,79 @@ static void parse_list(char *list)
   if (!TT.nelem) error_exit("missing positions list");
 }
 
-/*
- * retrive data from the file/s.
- */
-static void get_data(void)
+// Merge sorted list into non-overlapping ranges, so each range can be
+// written out in one go.
+static void merge_list(void)
 {
-  char **argv = toys.optargs; //file name.
-  toys.exitval = EXIT_SUCCESS;
-
-  if(!*argv) TT.do_cut(0); //for stdin
-  else {
-    for(; *argv; ++argv) {
-      if(strcmp(*argv, "-") == 0) TT.do_cut(0); //for stdin
-      else {
-        int fd = open(*argv, O_RDONLY, 0);
-        if (fd < 0) {//if file not present then continue with other files.
-          perror_msg_raw(*argv);
-          continue;
-        }
-        TT.do_cut(fd);
-        xclose(fd);
-      }
+  struct slist *sl, *next;
+
+  for (sl = TT.slist_head; sl; sl = sl->next) {
+    if (sl->end < 0) sl->end = sl->start;
+    while ((next = sl->next) && next->start <= sl->end+1L) {
+      if (next->end < 0) next->end = next->start;
+      if (next->end > sl->end) sl->end = next->end;
+      sl->next = next->next;
+      free(next);
     }
   }
 }
 
 // perform cut operation on the given delimiter.
-static void do_fcut(int fd)
+static void do_fcut(char *line, long len)
 {
-  char *buff, *pfield = 0, *delimiter = TT.delim;
-
-  for (;;) {
-    unsigned cpos = 0;
-    int start, ndelimiters = -1;
-    int  nprinted_fields = 0;
-    struct slist *temp_node = TT.slist_head;
-
-    free(pfield);
-    pfield = 0;
-
-    if (!(buff = get_line(fd))) break;
-
-    //does line have any delimiter?.
-    if (strrchr(buff, (int)delimiter[0]) == NULL) {
-      //if not then print whole line and move to next line.
-      if (!(toys.optflags & FLAG_s)) xputs(buff);
-      continue;
-    }
-
-    pfield = xzalloc(strlen(buff) + 1);
-
-    if (temp_node) {
-      //process list on each line.
-      while (cpos < TT.nelem && buff) {
-        if (!temp_node) break;
-        start = temp_node->start;
-        do {
-          char *field = 0;
-
-          //count number of delimeters per line.
-          while (buff) {
-            if (ndelimiters < start) {
-              ndelimiters++;
-              field = strsep(&buff, delimiter);
-            } else break;
-          }
-          //print field (if not yet printed).
-          if (!pfield[ndelimiters]) {
-            if (ndelimiters == start) {
-              //put delimiter.
-              if (nprinted_fields++ > 0) xputc(delimiter[0]);
-              if (field) fputs(field, stdout);
-              //make sure this field won't print again.
-              pfield[ndelimiters] = (char) 0x23; //put some char at this position.
-            }
-          }
-          start++;
-          if ((temp_node->end < 0) || !buff) break;          
-        } while(start <= temp_node->end);
-        temp_node = temp_node->next;
-        cpos++;
-      }
+  struct slist *sl;
+  char *s = line, *end = line+len, *next = 0, d = *TT.delim;
+  int field = 0, printed = 0;
+
+  //does line have any delimiter?.
+  if (!memchr(line, d, len)) {
+    //if not then print whole line and move to next line.
+    if (toys.optflags & FLAG_s) return;
+    fwrite(line, len, 1, stdout);
+  } else for (sl = TT.slist_head; sl && s; sl = sl->next) {
+    char *start;
+
+    // Skip to first field of range, then find end of last one.
+    for (; s && field < sl->start; field++)
+      if ((s = memchr(s, d, end-s))) s++;
+    if (!s) break;
+    for (start = s, next = 0; field <= sl->end; field++) {
+      if (!(next = memchr(s, d, end-s))) break;
+      s = next+1;
     }
-    xputc('\n');
+    if (printed++) putchar(d);
+    fwrite(start, (next ? next : end)-start, 1, stdout);
+    if (!next) s = 0;
   }
+  putchar('\n');
 }
 
 // perform cut operation char or byte.
-static void do_bccut(int fd)
+static void do_bccut(char *line, long len)
 {
-  char *buff;
-
-  while ((buff = get_line(fd)) != NULL) {
-    unsigned cpos = 0;
-    int buffln = strlen(buff);
-    char *pfield = xzalloc(buffln + 1);
-    struct slist *temp_node = TT.slist_head;
+  struct slist *sl;
 
-    if (temp_node != NULL) {
-      while (cpos < TT.nelem) {
-        int start;
+  for (sl = TT.slist_head; sl && sl->start < len; sl = sl->next)
+    fwrite(line+sl->start, (sl->end < len ? sl->end+1 : len)-sl->start, 1,
+      stdout);
+  putchar('\n');
+}
 
-        if (!temp_node) break;
-        start = temp_node->start;
-        while (start < buffln) {
-          //to avoid duplicate field printing.
-          if (pfield[start]) {
-              if (++start <= temp_node->end) continue;
-              temp_node = temp_node->next;
-              break;
-          } else {
-            //make sure this field won't print again.
-            pfield[start] = (char) 0x23; //put some char at this position.
-            xputc(buff[start]);
-          }
-          if (++start > temp_node->end) {
-            temp_node = temp_node->next;
-            break;
-          }
-        }
-        cpos++;
-      }
-      xputc('\n');
-    }
-    free(pfield);
-    pfield = NULL;
+// Read input with a buffered reader reusing one line buffer.
+static void do_cut(int fd, char *name)
+{
+  FILE *fp = fd ? xfdopen(fd, "r") : stdin;
+  char *line = 0;
+  size_t size = 0;
+  long len;
+
+  while (0 < (len = getline(&line, &size, fp))) {
+    if (line[len-1] == '\n') len--;
+    TT.do_cut(line, len);
   }
+  free(line);
+  if (fd) fclose(fp);
+  xflush();
 }
 
 void cut_main(void)
@@ -267,7 +215,8 @@ void cut_main(void)
   }
 
   parse_list(list);
-  get_data();
+  merge_list();
+  loopfiles_rw(toys.optargs, O_RDONLY|WARN_ONLY, 0, do_cut);
   if (!(toys.optflags & FLAG_d) && (toys.optflags & FLAG_f)) {
     free(TT.delim);
     TT.delim = NULL;
@@ -41,19 +41,19 @@ GLOBALS(
 
   unsigned long depth, total;
   dev_t st_dev;
-  void *inodes;
+  struct inode_hash inodes;
+
+  char *path;
+  unsigned long pathmax, stackmax;
+  struct {
+    dev_t dev;
+    ino_t ino;
+  } *stack;
 )
 
-typedef struct node_size {
-  struct dirtree *node;
-  long size;
-} node_size;
-
 // Print the size and name, given size in bytes
-static void print(long long size, struct dirtree *node)
+static void print(long long size, char *name)
 {
-  char *name = "total";
-
   if (TT.maxdepth && TT.depth > TT.maxdepth) return;
 
   if (toys.optflags & FLAG_h) {
@@ -67,91 +67,90 @@ static void print(long long size, struct dirtree *node)
 
     printf("%llu", (size>>bits)+!!(size&((1<<bits)-1)));
   }
-  if (node) name = dirtree_path(node, NULL);
-  xprintf("\t%s\n", name);
-  if (node) free(name);
+  xprintf("\t%s\n", name ? name : "total");
 }
 
-// Return whether or not we've seen this inode+dev, adding it to the list if
-// we haven't.
-static int seen_inode(void **list, struct stat *st)
+// Return 512 byte blocks used by name (relative to dirfd), recursing into
+// directories and printing as we go.
+//
+// This doesn't use dirtree: we don't need a node or a path string per entry,
+// just the ancestors' dev+ino (for -L loop detection) and one path buffer
+// holding the path to the current entry (len bytes of TT.path), which we
+// extend in place as we descend.
+static unsigned long long du_entry(int dirfd, char *name, int len, int follow)
 {
-  if (!st) llist_traverse(st, free);
-
-  // Skipping dir nodes isn't _quite_ right. They're not hardlinked, but could
-  // be bind mounted. Still, it's more efficient and the archivers can't use
-  // hardlinked directory info anyway. (Note that we don't catch bind mounted
-  // _files_ because it doesn't change st_nlink.)
-  else if (!S_ISDIR(st->st_mode) && st->st_nlink > 1) {
-    struct inode_list {
-      struct inode_list *next;
-      ino_t ino;
-      dev_t dev;
-    } *new;
-
-    for (new = *list; new; new = new->next)
-      if(new->ino == st->st_ino && new->dev == st->st_dev)
-        return 1;
-
-    new = xzalloc(sizeof(*new));
-    new->ino = st->st_ino;
-    new->dev = st->st_dev;
-    new->next = *list;
-    *list = new;
-  }
-
-  return 0;
-}
+  unsigned long long blocks;
+  struct stat st;
+  unsigned long i;
 
-// dirtree callback, compute/display size of node
-static int do_du(struct dirtree *node)
-{
-  unsigned long blocks;
-
-  if (!node->parent) TT.st_dev = node->st.st_dev;
-  else if (!dirtree_notdotdot(node)) return 0;
+  if (stat_fields(dirfd, name, &st, follow ? 0 : AT_SYMLINK_NOFOLLOW,
+      STATX_TYPE|STATX_MODE|STATX_BLOCKS|STATX_INO
+      |STATX_NLINK*!(toys.optflags&FLAG_l)))
+  {
+    perror_msg("%s", TT.path);
 
-  // detect swiching filesystems
-  if ((toys.optflags & FLAG_x) && (TT.st_dev != node->st.st_dev))
     return 0;
+  }
 
-  // Don't loop endlessly on recursive directory symlink
-  if (toys.optflags & FLAG_L) {
-    struct dirtree *try = node;
+  // detect swiching filesystems
+  if (!TT.depth) TT.st_dev = st.st_dev;
+  else if ((toys.optflags & FLAG_x) && TT.st_dev != st.st_dev) return 0;
 
-    while ((try = try->parent))
-      if (node->st.st_dev==try->st.st_dev && node->st.st_ino==try->st.st_ino)
-        return 0;
-  }
+  // Don't count hard links twice. Skipping dir nodes isn't _quite_ right.
+  // They're not hardlinked, but could be bind mounted. Still, it's more
+  // efficient and the archivers can't use hardlinked directory info anyway.
+  // (Note that we don't catch bind mounted _files_ because it doesn't change
+  // st_nlink.)
+  if (!(toys.optflags & FLAG_l) && st.st_nlink > 1 && !S_ISDIR(st.st_mode))
+    if (seen_inode(&TT.inodes, st.st_dev, st.st_ino, 0)) return 0;
 
-  // Don't count hard links twice
-  if (!(toys.optflags & FLAG_l) && !node->again)
-    if (seen_inode(&TT.inodes, &node->st)) return 0;
+  blocks = st.st_blocks;
 
   // Collect child info before printing directory size
-  if (S_ISDIR(node->st.st_mode)) {
-    if (!node->again) {
-      TT.depth++;
-      return DIRTREE_COMEAGAIN|(DIRTREE_SYMFOLLOW*!!(toys.optflags&FLAG_L));
-    } else TT.depth--;
+  if (S_ISDIR(st.st_mode)) {
+    struct dirent *dd;
+    DIR *dir;
+    int fd, olen = len, base = len;
+
+    // Don't loop endlessly on recursive directory symlink
+    if (toys.optflags & FLAG_L)
+      for (i = 0; i<TT.depth; i++)
+        if (TT.stack[i].dev == st.st_dev && TT.stack[i].ino == st.st_ino)
+          return 0;
+
+    if (TT.depth == TT.stackmax)
+      TT.stack = xrealloc(TT.stack, (TT.stackmax += 64)*sizeof(*TT.stack));
+    TT.stack[TT.depth].dev = st.st_dev;
+    TT.stack[TT.depth++].ino = st.st_ino;
+
+    if (-1 == (fd = openat(dirfd, name, O_RDONLY|O_CLOEXEC))
+        || !(dir = fdopendir(fd)))
+    {
+      perror_msg("No %s", TT.path);
+      if (fd != -1) close(fd);
+    } else {
+      if (base && TT.path[base-1] != '/') TT.path[base++] = '/';
+      while ((dd = readdir(dir))) {
+        name = dd->d_name;
+        if (name[0]=='.' && (!name[1] || (name[1]=='.' && !name[2])))
+          continue;
+        len = strlen(name);
+        if (base+len >= TT.pathmax)
+          TT.path = xrealloc(TT.path, TT.pathmax = base+len+256);
+        memcpy(TT.path+base, name, len+1);
+        blocks += du_entry(fd, name, base+len, toys.optflags & FLAG_L);
+      }
+      closedir(dir);
+    }
+    TT.depth--;
+    TT.path[len = olen] = 0;
   }
 
-  // Modern compilers' optimizers are insane and think signed overflow
-  // behaves differently than unsigned overflow. Sigh. Big hammer.
-  blocks = node->st.st_blocks + (unsigned long)node->extra;
-  node->extra = blocks;
-  if (node->parent)
-    node->parent->extra = (unsigned long)node->parent->extra+blocks;
-  else TT.total += node->extra;
+  if ((toys.optflags & FLAG_a) || !TT.depth
+      || (S_ISDIR(st.st_mode) && !(toys.optflags & FLAG_s)))
+    print(blocks*512LL, TT.path);
 
-  if ((toys.optflags & FLAG_a) || !node->parent
-      || (S_ISDIR(node->st.st_mode) && !(toys.optflags & FLAG_s)))
-  {
-    blocks = node->extra;
-    print(blocks*512LL, node);
-  }
-
-  return 0;
+  return blocks;
 }
 
 void du_main(void)
@@ -159,10 +158,19 @@ void du_main(void)
   char *noargs[] = {".", 0}, **args;
 
   // Loop over command line arguments, recursing through children
-  for (args = toys.optc ? toys.optargs : noargs; *args; args++)
-    dirtree_flagread(*args, DIRTREE_SYMFOLLOW*!!(toys.optflags&(FLAG_H|FLAG_L)),
-      do_du);
+  for (args = toys.optc ? toys.optargs : noargs; *args; args++) {
+    int len = strlen(*args);
+
+    if (len >= TT.pathmax) TT.path = xrealloc(TT.path, TT.pathmax = len+256);
+    strcpy(TT.path, *args);
+    TT.total += du_entry(AT_FDCWD, *args, len,
+      toys.optflags & (FLAG_H|FLAG_L));
+  }
   if (toys.optflags & FLAG_c) print(TT.total*512, 0);
 
-  if (CFG_TOYBOX_FREE) seen_inode(TT.inodes, 0);
+  if (CFG_TOYBOX_FREE) {
+    free_inode_hash(&TT.inodes);
+    free(TT.path);
+    free(TT.stack);
+  }
 }
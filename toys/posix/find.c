@@ -10,18 +10,19 @@
  *
  * TODO: -empty (dirs too!)
 
-USE_FIND(NEWTOY(find, "?^HL[-HL]", TOYFLAG_USR|TOYFLAG_BIN))
+USE_FIND(NEWTOY(find, "?^j#<0HL[-HL]", TOYFLAG_USR|TOYFLAG_BIN))
 
 config FIND
   bool "find"
   default y
   help
-    usage: find [-HL] [DIR...] [<options>]
+    usage: find [-HL] [-j N] [DIR...] [<options>]
 
     Search directories for matching files.
     Default: search "." match all -print all matches.
 
     -H  Follow command line symlinks         -L  Follow all symlinks
+    -j  Run up to N "-exec +" commands at once (0 = one per processor)
 
     Match filters:
     -name  PATTERN  filename with wildcards   -iname      case insensitive -name
@@ -56,9 +57,11 @@ config FIND
 #include "toys.h"
 
 GLOBALS(
+  long jobs;
+
   char **filter;
   struct double_list *argdata;
-  int topdir, xdev, depth;
+  int topdir, xdev, depth, stat, running;
   time_t now;
 )
 
@@ -120,7 +123,15 @@ static int flush_exec(struct dirtree *new, struct exec_range *aa)
     newargs[pos+rest] = 0;
   }
 
-  rc = xrun(newargs);
+  // -exec + batches don't produce a test result, so with -j we can leave
+  // them running and collect exit status later, reaping one when we're full.
+  if (aa->plus && TT.jobs > 1) {
+    for (; TT.running >= TT.jobs; TT.running--) toys.exitval |= xwaitpid(-1);
+    xpopen_both(newargs, 0);
+    TT.running++;
+    rc = 0;
+  } else rc = xrun(newargs);
+  free(newargs);
 
   llist_traverse(bb->names, llist_free_double);
   bb->names = 0;
@@ -200,7 +211,8 @@ static int do_find(struct dirtree *new)
   struct double_list *argdata = TT.argdata;
   char *s, **ss;
 
-  recurse = DIRTREE_COMEAGAIN|(DIRTREE_SYMFOLLOW*!!(toys.optflags&FLAG_L));
+  recurse = DIRTREE_COMEAGAIN|(DIRTREE_SYMFOLLOW*!!(toys.optflags&FLAG_L))
+            |(DIRTREE_STATLESS*!TT.stat);
 
   // skip . and .. below topdir, handle -xdev and -depth
   if (new) {
@@ -277,6 +289,16 @@ static int do_find(struct dirtree *new)
       continue;
     } else s++;
 
+    // Note tests needing more than the name and type readdir() gives us
+    if (!new) {
+      char *stats[] = {"perm", "user", "group", "nouser", "nogroup", "atime",
+                       "ctime", "mtime", "size", "links", "newer"};
+      int i;
+
+      for (i = 0; i<ARRAY_LEN(stats); i++)
+        if (!strcmp(s, stats[i])) TT.stat++;
+    }
+
     if (!strcmp(s, "xdev")) TT.xdev = 1;
     else if (!strcmp(s, "delete")) {
       // Delete forces depth first
@@ -489,10 +511,13 @@ static int do_find(struct dirtree *new)
             // Done here vs argument parsing pass so it's after dlist_terminate
             aa->prev = (void *)1;
 
-            // Flush if we pass 16 megs of environment space.
+            // Flush if we pass 16 megs of environment space (128k with -j
+            // so there are batches to run in parallel).
             // An insanely long path (>2 gigs) could wrap the counter and
             // defeat this test, which could potentially trigger OOM killer.
-            if ((aa->plus += sizeof(char *)+strlen(name)+1) > 1<<24) {
+            if ((aa->plus += sizeof(char *)+strlen(name)+1)
+                > (TT.jobs > 1 ? 1<<17 : 1<<24))
+            {
               aa->plus = 1;
               toys.exitval |= flush_exec(new, aa);
             }
@@ -546,6 +571,9 @@ void find_main(void)
     len = 1;
   }
 
+  if ((toys.optflags & FLAG_j) && !TT.jobs)
+    TT.jobs = sysconf(_SC_NPROCESSORS_ONLN);
+
   // first pass argument parsing, verify args match up, handle "evaluate once"
   TT.now = time(0);
   do_find(0);
@@ -556,6 +584,7 @@ void find_main(void)
       do_find);
 
   execdir(0, 1);
+  for (; TT.running; TT.running--) toys.exitval |= xwaitpid(-1);
 
   if (CFG_TOYBOX_FREE) {
     close(TT.topdir);
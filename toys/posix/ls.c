@@ -5,13 +5,13 @@
  *
  * See http://opengroup.org/onlinepubs/9699919799/utilities/ls.html
 
-USE_LS(NEWTOY(ls, USE_LS_COLOR("(color):;")"ZgoACFHLRSabcdfhiklmnpqrstux1[-Cxm1][-Cxml][-Cxmo][-Cxmg][-cu][-ftS][-HL][!qb]", TOYFLAG_BIN|TOYFLAG_LOCALE))
+USE_LS(NEWTOY(ls, USE_LS_COLOR("(color):;")"ZgoACFHLRSUabcdfhiklmnpqrstux1[-Cxm1][-Cxml][-Cxmo][-Cxmg][-cu][-ftSU][-HL][!qb]", TOYFLAG_BIN|TOYFLAG_LOCALE))
 
 config LS
   bool "ls"
   default y
   help
-    usage: ls [-ACFHLRSZacdfhiklmnpqrstux1] [directory...]
+    usage: ls [-ACFHLRSUZacdfhiklmnpqrstux1] [directory...]
 
     list files
 
@@ -33,7 +33,10 @@ config LS
     -x  columns (horizontal sort)
 
     sorting (default is alphabetical):
-    -f  unsorted    -r  reverse    -t  timestamp    -S  size
+    -f  unsorted (implies -a)    -r  reverse    -t  timestamp    -S  size
+    -U  unsorted
+
+    Unsorted output with -1 and no -ilsZ is written as the directory is read.
 
 config LS_COLOR
   bool "ls --color"
@@ -60,7 +63,7 @@ GLOBALS(
   struct dirtree *files, *singledir;
 
   unsigned screen_width;
-  int nl_title;
+  int nl_title, stream;
   char *escmore;
 )
 
@@ -179,18 +182,26 @@ static int compare(void *a, void *b)
   return ret * reverse;
 }
 
+int color_from_mode(mode_t mode)
+{
+  int color = 0;
+
+  if (S_ISDIR(mode)) color = 256+34;
+  else if (S_ISLNK(mode)) color = 256+36;
+  else if (S_ISBLK(mode) || S_ISCHR(mode)) color = 256+33;
+  else if (S_ISREG(mode) && (mode&0111)) color = 256+32;
+  else if (S_ISFIFO(mode)) color = 33;
+  else if (S_ISSOCK(mode)) color = 256+35;
+
+  return color;
+}
+
 // callback from dirtree_recurse() determining how to handle this entry.
 
 static int filter(struct dirtree *new)
 {
   int flags = toys.optflags;
 
-  // Special case to handle enormous dirs without running out of memory.
-  if (flags == (FLAG_1|FLAG_f)) {
-    xprintf("%s\n", new->name);
-    return 0;
-  }
-
   if (flags & FLAG_Z) {
     if (!CFG_TOYBOX_LSM_NONE) {
 
@@ -224,10 +235,27 @@ static int filter(struct dirtree *new)
   if (flags & FLAG_c) new->st.st_mtime = new->st.st_ctime;
   new->st.st_blocks >>= 1;
 
-  if (flags & (FLAG_a|FLAG_f)) return DIRTREE_SAVE;
-  if (!(flags & FLAG_A) && new->name[0]=='.') return 0;
+  if (!(flags & (FLAG_a|FLAG_f))) {
+    if (!(flags & FLAG_A) && new->name[0]=='.') return 0;
+    if (!dirtree_notdotdot(new)) return 0;
+  }
+
+  // Print streaming entries now so enormous dirs don't have to fit in memory,
+  // only keeping subdirectories around for -R to descend into later.
+  if (TT.stream && new->parent != TT.files) {
+    char *ss = new->name, et = endtype(&new->st);
+    int color = (flags & FLAG_color) ? color_from_mode(new->st.st_mode) : 0;
+
+    if (color) printf("\033[%d;%dm", color>>8, color&255);
+    crunch_str(&ss, INT_MAX, stdout, TT.escmore, crunch_qb);
+    if (color) printf("\033[0m");
+    if (et) xputc(et);
+    xputc('\n');
+
+    return DIRTREE_SAVE*((flags & FLAG_R) && S_ISDIR(new->st.st_mode));
+  }
 
-  return dirtree_notdotdot(new) & DIRTREE_SAVE;
+  return DIRTREE_SAVE;
 }
 
 // For column view, calculate horizontal position (for padding) and return
@@ -272,20 +300,6 @@ static unsigned long next_column(unsigned long ul, unsigned long dtlen,
   return (*xpos*height) + widecols + (ul/(columns-1));
 }
 
-int color_from_mode(mode_t mode)
-{
-  int color = 0;
-
-  if (S_ISDIR(mode)) color = 256+34;
-  else if (S_ISLNK(mode)) color = 256+36;
-  else if (S_ISBLK(mode) || S_ISCHR(mode)) color = 256+33;
-  else if (S_ISREG(mode) && (mode&0111)) color = 256+32;
-  else if (S_ISFIFO(mode)) color = 33;
-  else if (S_ISSOCK(mode)) color = 256+35;
-
-  return color;
-}
-
 // Display a list of dirtree entries, according to current format
 // Output types -1, -l, -C, or stream
 
@@ -293,6 +307,7 @@ static void listfiles(int dirfd, struct dirtree *indir)
 {
   struct dirtree *dt, **sort;
   unsigned long dtlen, ul = 0;
+  int stream = TT.stream && indir->parent;
   unsigned width, flags = toys.optflags, totals[8], len[8], totpad = 0,
     *colsizes = (unsigned *)(toybuf+260), columns = (sizeof(toybuf)-260)/4;
   char tmp[64];
@@ -320,11 +335,23 @@ static void listfiles(int dirfd, struct dirtree *indir)
 
     // Do preprocessing (Dirtree didn't populate, so callback wasn't called.)
     for (;dt; dt = dt->next) filter(dt);
-    if (flags == (FLAG_1|FLAG_f)) return;
-  // Read directory contents. We dup() the fd because this will close it.
-  // This reads/saves contents to display later, except for in "ls -1f" mode.
-  } else  dirtree_recurse(indir, filter, dup(dirfd),
-      DIRTREE_SYMFOLLOW*!!(flags&FLAG_L));
+  } else {
+    // Label directory if not top of tree, or if -R
+    if (TT.singledir!=indir || (flags&FLAG_R)) {
+      char *path = dirtree_path(indir, 0);
+
+      if (TT.nl_title++) xputc('\n');
+      xprintf("%s:\n", path);
+      free(path);
+    }
+
+    // Read directory contents. We dup() the fd because this will close it.
+    // This reads/saves contents to display later, except when streaming.
+    dirtree_recurse(indir, filter, dup(dirfd),
+      DIRTREE_SYMFOLLOW*!!(flags&FLAG_L) | DIRTREE_STATLESS*!(flags
+        &(FLAG_l|FLAG_o|FLAG_n|FLAG_g|FLAG_s|FLAG_i|FLAG_h|FLAG_t|FLAG_S
+          |FLAG_F|FLAG_color)));
+  }
 
   // Copy linked list to array and sort it. Directories go in array because
   // we visit them in sorted order too. (The nested loops let us measure and
@@ -335,21 +362,11 @@ static void listfiles(int dirfd, struct dirtree *indir)
     if (sort || !dtlen) break;
   }
 
-  // Label directory if not top of tree, or if -R
-  if (indir->parent && (TT.singledir!=indir || (flags&FLAG_R)))
-  {
-    char *path = dirtree_path(indir, 0);
-
-    if (TT.nl_title++) xputc('\n');
-    xprintf("%s:\n", path);
-    free(path);
-  }
-
   // Measure each entry to work out whitespace padding and total blocks
   if (!(flags & FLAG_f)) {
     unsigned long long blocks = 0;
 
-    qsort(sort, dtlen, sizeof(void *), (void *)compare);
+    if (!(flags & FLAG_U)) qsort(sort, dtlen, sizeof(void *), (void *)compare);
     for (ul = 0; ul<dtlen; ul++) {
       entrylen(sort[ul], len);
       for (width = 0; width<8; width++)
@@ -395,7 +412,7 @@ static void listfiles(int dirfd, struct dirtree *indir)
   // Loop through again to produce output.
   memset(toybuf, ' ', 256);
   width = 0;
-  for (ul = 0; ul<dtlen; ul++) {
+  for (ul = 0; !stream && ul<dtlen; ul++) {
     int ii;
     unsigned curcol, color = 0;
     unsigned long next = next_column(ul, dtlen, columns, &curcol);
@@ -544,6 +561,8 @@ void ls_main(void)
   // but currently it has "switch off when this is set", so "-dR" and "-Rd"
   // behave differently
   if (toys.optflags & FLAG_d) toys.optflags &= ~FLAG_R;
+  TT.stream = (toys.optflags&(FLAG_f|FLAG_U)) && (toys.optflags&FLAG_1)
+    && !(toys.optflags&(FLAG_l|FLAG_o|FLAG_n|FLAG_g|FLAG_i|FLAG_s|FLAG_Z));
 
   // Iterate through command line arguments, collecting directories and files.
   // Non-absolute paths are relative to current directory. Top of tree is
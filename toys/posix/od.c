@@ -34,9 +34,10 @@ GLOBALS(
   long jump_bytes;
 
   int address_idx;
-  unsigned types, leftover, star;
+  unsigned types, leftover, star, pad;
   char *buf; // Points to buffers[0] or buffers[1].
   char *bufs[2]; // Used to detect duplicate lines.
+  char *line;
   off_t pos;
 )
 
@@ -46,90 +47,97 @@ static char *ascii = "nulsohstxetxeotenqackbel bs ht nl vt ff cr so si"
 struct odtype {
   int type;
   int size;
+  int width;        // Widest value this type can print
+  char (*table)[5]; // Preformatted single byte values, length in [4]
 };
 
-static int od_out_t(struct odtype *t, char *buf, int *offset)
+// Format one value starting at in, return length of text written to out
+static int od_out_t(struct odtype *t, char *in, char *out)
 {
   unsigned k;
-  int throw = 0, pad = 0;
 
   // Handle ascii
   if (t->type < 2) {
-    char c = TT.buf[(*offset)++];
-    pad += 4;
+    char c = *in;
 
     if (!t->type) {
       c &= 127;
-      if (c<=32) sprintf(buf, "%.3s", ascii+(3*c));
-      else if (c==127) strcpy(buf, "del");
-      else sprintf(buf, "%c", c);
+      if (c<=32) memcpy(out, ascii+(3*c), k = 3);
+      else if (c==127) memcpy(out, "del", k = 3);
+      else *out = c, k = 1;
     } else {
       char *bfnrtav = "\b\f\n\r\t\a\v", *s = strchr(bfnrtav, c);
-      if (s) sprintf(buf, "\\%c", "bfnrtav0"[s-bfnrtav]);
-      else if (c < 32 || c >= 127) sprintf(buf, "%03o", c);
-      else {
+
+      k = 3;
+      if (s) {
+        *out++ = '\\';
+        *out = "bfnrtav0"[s-bfnrtav];
+        k = 2;
+      } else if (c < 32 || c >= 127) {
+        *out++ = '0'+(c>>6);
+        *out++ = '0'+((c>>3)&7);
+        *out = '0'+(c&7);
+      } else {
         // TODO: this should be UTF8 aware.
-        sprintf(buf, "%c", c);
+        *out = c;
+        k = 1;
       }
     }
   } else if (CFG_TOYBOX_FLOAT && t->type == 6) {
     long double ld;
     union {float f; double d; long double ld;} fdl;
 
-    memcpy(&fdl, TT.buf+*offset, t->size);
-    *offset += t->size;
-    if (sizeof(float) == t->size) {
-      ld = fdl.f;
-      pad += (throw = 8)+7;
-    } else if (sizeof(double) == t->size) {
-      ld = fdl.d;
-      pad += (throw = 17)+8;
-    } else if (sizeof(long double) == t->size) {
-      ld = fdl.ld;
-      pad += (throw = 21)+9;
-    } else error_exit("bad -tf '%d'", t->size);
-
-    sprintf(buf, "%.*Le", throw, ld);
+    memcpy(&fdl, in, t->size);
+    if (sizeof(float) == t->size) ld = fdl.f, k = 8;
+    else if (sizeof(double) == t->size) ld = fdl.d, k = 17;
+    else ld = fdl.ld, k = 21;
+
+    k = sprintf(out, "%.*Le", k, ld);
   // Integer types
   } else {
     unsigned long long ll = 0, or;
-    char *c[] = {"%*lld", "%*llu", "%0*llo", "%0*llx"},
-      *class = c[t->type-2];
-
-    // Work out width of field
-    if (t->size == 8) {
-      or = -1LL;
-      if (t->type == 2) or >>= 1;
-    } else or = (1LL<<(8*t->size))-1;
-    throw = sprintf(buf, class, 0, or);
+    char tmp[24], *s = tmp+sizeof(tmp);
 
     // Accumulate integer based on size argument
     for (k=0; k < t->size; k++) {
-      or = TT.buf[(*offset)++];
+      or = in[k];
       ll |= or << (8*(IS_BIG_ENDIAN ? t->size-k-1 : k));
     }
 
     // Handle negative values
-    if (t->type == 2) {
-      or = sizeof(or) - t->size;
-      throw++;
-      if (or && (ll & (1l<<((8*t->size)-1))))
-        ll |= ((or<<(8*or))-1) << (8*t->size);
+    if (t->type == 2 && t->size < 8 && (ll & (1ULL<<((8*t->size)-1))))
+      ll |= -1ULL << (8*t->size);
+
+    // Convert to text, back to front
+    if (t->type > 3) {
+      k = 3+(t->type == 5);
+      do *--s = "0123456789abcdef"[ll & ((1<<k)-1)]; while (ll >>= k);
+    } else {
+      if (t->type == 2 && (long long)ll < 0) ll = -ll, k = 1;
+      else k = 0;
+      do *--s = '0'+(ll%10); while (ll /= 10);
+      if (k) *--s = '-';
     }
 
-    sprintf(buf, class, throw, ll);
-    pad += throw+1;
+    // Octal and hex are zero padded, decimal space padded
+    k = tmp+sizeof(tmp)-s;
+    if (k < t->width) {
+      memset(out, (t->type > 3) ? '0' : ' ', t->width-k);
+      out += t->width-k;
+    }
+    memcpy(out, s, k);
+    if (k < t->width) k = t->width;
   }
 
-  return pad;
+  return k;
 }
 
 static void od_outline(void)
 {
   unsigned flags = toys.optflags;
-  char buf[128], *abases[] = {"", "%07lld", "%07llo", "%06llx"};
+  char buf[128], *s, *out = TT.line, *abases[] = {"", "%07lld", "%07llo", "%06llx"};
   struct odtype *types = (struct odtype *)toybuf;
-  int i, j, len, pad;
+  int i, j, k, len;
 
   if (TT.leftover<TT.width) memset(TT.buf+TT.leftover, 0, TT.width-TT.leftover);
 
@@ -147,9 +155,11 @@ static void od_outline(void)
     TT.star = 0;
 
     // off_t varies so expand it to largest possible size
-    xprintf(abases[TT.address_idx], (long long)TT.pos);
+    out += sprintf(out, abases[TT.address_idx], (long long)TT.pos);
     if (!TT.leftover) {
-      if (TT.address_idx) xputc('\n');
+      if (TT.address_idx) *out++ = '\n';
+      fwrite(TT.line, 1, out-TT.line, stdout);
+
       return;
     }
   }
@@ -158,29 +168,27 @@ static void od_outline(void)
   TT.leftover = 0;
   if (TT.star) return;
 
-  // Find largest "pad" of the output types.
-  for (i = pad = 0; i<TT.types; i++) {
-    int bytes = 0;
-
-    // If more than one byte of input consumed, average rounding up.
-    j = od_out_t(types+i, buf, &bytes);
-    j = (j+bytes-1)/bytes;
-   
-    if (j > pad) pad = j;
-  }
-
-  // For each output type, print one line
+  // For each output type, format one line
   for (i=0; i<TT.types; i++) {
-    for (j = 0; j<len;) {
-      int bytes = j;
+    struct odtype *t = types+i;
 
+    for (j = 0; j<len; j += t->size) {
       // pad for as many bytes as were consumed, and indent non-numbered lines
-      od_out_t(types+i, buf, &bytes);
-      xprintf("%*s", pad*(bytes-j) + 7*(!!i)*!j, buf);
-      j = bytes;
+      int pad = TT.pad*t->size + 7*(!!i)*!j;
+
+      if (t->table) k = (s = t->table[TT.buf[j]])[4];
+      else k = od_out_t(t, TT.buf+j, s = buf);
+      if (k < pad) {
+        memset(out, ' ', pad-k);
+        out += pad-k;
+      }
+      memcpy(out, s, k);
+      out += k;
     }
-    xputc('\n');
+    *out++ = '\n';
   }
+  if (fwrite(TT.line, 1, out-TT.line, stdout) != out-TT.line)
+    perror_exit("write");
 
   // Toggle buffer for "same as last time" check.
   TT.buf = (TT.buf == TT.bufs[0]) ? TT.bufs[1] : TT.bufs[0];
@@ -227,7 +235,7 @@ static void append_base(char *base)
   int type;
 
   for (;;) {
-    int size = 1;
+    int size = 1, width = 3;
 
     if (!*s) return;
     if (TT.types >= sizeof(toybuf)/sizeof(struct odtype)) break;
@@ -253,8 +261,25 @@ static void append_base(char *base)
       }
     }
 
+    // Work out width of field
+    if (CFG_TOYBOX_FLOAT && type == 6) {
+      if (size == sizeof(float)) width = 14;
+      else if (size == sizeof(double)) width = 24;
+      else if (size == sizeof(long double)) width = 29;
+      else break;
+    } else if (type > 1) {
+      char *c[] = {"%*lld", "%*llu", "%0*llo", "%0*llx"};
+      unsigned long long or = -1LL;
+
+      if (size != 8) or = (1LL<<(8*size))-1;
+      else if (type == 2) or >>= 1;
+      width = snprintf(0, 0, c[type-2], 0, or) + (type == 2);
+    }
+
     types[TT.types].type = type;
     types[TT.types].size = size;
+    types[TT.types].width = width;
+    types[TT.types].table = 0;
     TT.types++;
   }
 
@@ -263,10 +288,13 @@ static void append_base(char *base)
 
 void od_main(void)
 {
+  struct odtype *types = (struct odtype *)toybuf;
   struct arg_list *arg;
+  int i, j;
 
-  TT.bufs[0] = xzalloc(TT.width);
-  TT.bufs[1] = xzalloc(TT.width);
+  // Slack at the end for a partial value of a multibyte type
+  TT.bufs[0] = xzalloc(TT.width+16);
+  TT.bufs[1] = xzalloc(TT.width+16);
   TT.buf = TT.bufs[0];
 
   if (!TT.address_base) TT.address_idx = 2;
@@ -284,13 +312,34 @@ void od_main(void)
   if (toys.optflags & FLAG_x) append_base("x2");
   if (!TT.types) append_base("o2");
 
+  // Find largest per-byte "pad" of the output types (including the space
+  // between values), and preformat all 256 values of single byte types.
+  for (i = 0; i<TT.types; i++) {
+    struct odtype *t = types+i;
+
+    j = (t->width+t->size)/t->size;
+    if (j > TT.pad) TT.pad = j;
+    if (t->size == 1) {
+      t->table = xmalloc(256*sizeof(*t->table));
+      for (j = 0; j<256; j++) {
+        char c = j;
+
+        t->table[j][4] = od_out_t(t, &c, t->table[j]);
+      }
+    }
+  }
+  TT.line = xmalloc(32+TT.types*(TT.width+16)*(TT.pad+40));
+
   loopfiles(toys.optargs, do_od);
 
   if (TT.leftover) od_outline();
   od_outline();
+  xflush();
 
   if (CFG_TOYBOX_FREE) {
+    for (i = 0; i<TT.types; i++) free(types[i].table);
     free(TT.bufs[0]);
     free(TT.bufs[1]);
+    free(TT.line);
   }
 }
@@ -43,10 +43,10 @@
  * TODO: top: thread support and SMP
  * TODO: pgrep -f only searches the amount of cmdline that fits in toybuf.
 
-USE_PS(NEWTOY(ps, "k(sort)*P(ppid)*aAdeflMno*O*p(pid)*s*t*Tu*U*g*G*wZ[!ol][+Ae][!oO]", TOYFLAG_USR|TOYFLAG_BIN|TOYFLAG_LOCALE))
+USE_PS(NEWTOY(ps, "(jobs)#<1k(sort)*P(ppid)*aAdeflMno*O*p(pid)*s*t*Tu*U*g*G*wZ[!ol][+Ae][!oO]", TOYFLAG_USR|TOYFLAG_BIN|TOYFLAG_LOCALE))
 // stayroot because iotop needs root to read other process' proc/$$/io
-USE_TOP(NEWTOY(top, ">0m" "O*Hk*o*p*u*s#<1d#=3<1n#<1bq[!oO]", TOYFLAG_USR|TOYFLAG_BIN|TOYFLAG_LOCALE))
-USE_IOTOP(NEWTOY(iotop, ">0AaKO" "k*o*p*u*s#<1=7d#=3<1n#<1bq", TOYFLAG_USR|TOYFLAG_BIN|TOYFLAG_STAYROOT|TOYFLAG_LOCALE))
+USE_TOP(NEWTOY(top, ">0m" "O*Hk*o*p*u*s#<1d#=3<1n#<1bqJC[!oO]", TOYFLAG_USR|TOYFLAG_BIN|TOYFLAG_LOCALE))
+USE_IOTOP(NEWTOY(iotop, ">0AaKO" "k*o*p*u*s#<1=7d#=3<1n#<1bqJC", TOYFLAG_USR|TOYFLAG_BIN|TOYFLAG_STAYROOT|TOYFLAG_LOCALE))
 USE_PGREP(NEWTOY(pgrep, "?cld:u*U*t*s*P*g*G*fnovxL:[-no]", TOYFLAG_USR|TOYFLAG_BIN))
 USE_PKILL(NEWTOY(pkill,    "?Vu*U*t*s*P*g*G*fnovxl:[-no]", TOYFLAG_USR|TOYFLAG_BIN))
 
@@ -54,7 +54,7 @@ config PS
   bool "ps"
   default y
   help
-    usage: ps [-AadefLlnwZ] [-gG GROUP,] [-k FIELD,] [-o FIELD,] [-p PID,] [-t TTY,] [-uU USER,]
+    usage: ps [-AadefLlnwZ] [-gG GROUP,] [--jobs N] [-k FIELD,] [-o FIELD,] [-p PID,] [-t TTY,] [-uU USER,]
 
     List processes.
 
@@ -80,6 +80,7 @@ config PS
     -M	Measure field widths (expanding as necessary)
     -n	Show numeric USER and GROUP
     -w	Wide output (don't truncate at terminal width)
+    --jobs N	Read /proc with N parallel worker processes (not with -k or -M)
 
     Which FIELDs to show. (Default = -o PID,TTY,TIME,CMD)
 
@@ -162,13 +163,15 @@ config TOP_COMMON
   bool
   default y
   help
-    usage: * [-bq] [-n NUMBER] [-d SECONDS] [-p PID,] [-u USER,]
+    usage: * [-bqJC] [-n NUMBER] [-d SECONDS] [-p PID,] [-u USER,]
 
     -b	Batch mode (no tty)
+    -C	Only show processes whose CPU time or I/O changed
     -d	Delay SECONDS between each cycle (default 3)
     -n	Exit after NUMBER iterations
     -p	Show these PIDs
     -u	Show these USERs
+    -J	JSON output (one line of FIELDS per process per update, implies -bq)
     -q	Quiet (no header lines)
 
     Cursor LEFT/RIGHT to change sort, UP/DOWN move list, space to force
@@ -221,6 +224,9 @@ config PGKILL_COMMON
 
 #define FOR_ps
 #include "toys.h"
+#include <linux/netlink.h>
+#include <linux/connector.h>
+#include <linux/cn_proc.h>
 
 GLOBALS(
   union {
@@ -236,6 +242,7 @@ GLOBALS(
       struct arg_list *o;
       struct arg_list *P;
       struct arg_list *k;
+      long jobs;
     } ps;
     struct {
       long n;
@@ -266,7 +273,7 @@ GLOBALS(
 
   struct sysinfo si;
   struct ptr_len gg, GG, pp, PP, ss, tt, uu, UU;
-  struct dirtree *threadparent;
+  struct dirtree *threadparent, *shard;
   unsigned width, height;
   dev_t tty;
   void *fields, *kfields;
@@ -274,6 +281,11 @@ GLOBALS(
   int kcount, forcek, sortpos;
   int (*match_process)(long long *slot);
   void (*show_process)(void *tb);
+
+  struct procfd **procs;
+  unsigned procmask, proccount, procgen, procfds, maxfds;
+  int events, statlen;
+  struct reread stat;
 )
 
 struct strawberry {
@@ -590,12 +602,112 @@ static void show_ps(struct carveup *tb)
     else width -= printf("%*.*s", pad, len, out);
     if (!width) break;
   }
-  xputc(TT.time ? '\r' : '\n');
+  putchar(TT.time ? '\r' : '\n');
+}
+
+// Parse /proc/$PID/stat only as far as the last field -o or -k needs.
+static void set_statlen(void)
+{
+  struct strawberry *field;
+  long long bits = TT.bits;
+
+  for (field = TT.kfields; field; field = field->next)
+    bits |= 1LL<<field->which;
+  TT.statlen = (bits&(_PS_ADDR|_PS_PSR|_PS_CPU|_PS_RTPRIO|_PS_SCH))
+    ? SLOT_count : SLOT_rsslim;
 }
 
 // dirtree callback: read data about process to display, store, or discard it.
 // Fills toybuf with struct carveup and either DIRTREE_SAVEs a copy to ->extra
 // (in -k mode) or calls show_ps on toybuf (no malloc/copy/free there).
+// top re-reads the same /proc files for every task each refresh, so it keeps
+// them open (re-reading with pread()) in a hash table indexed by tid, along
+// with the strings that don't change during the life of a process.
+struct procfd {
+  long long tid, bits, argv0len;
+  unsigned gen, uid, gid;
+  int fd[5];                  // stat, status, io, statm, wchan (-1 = closed)
+  unsigned short offset[6];   // copy of carveup->offset[]
+  char *str;                  // copy of carveup->str[]
+};
+
+static void procfd_reset(struct procfd *pf)
+{
+  int i;
+
+  for (i = 0; i<ARRAY_LEN(pf->fd); i++) {
+    if (pf->fd[i] == -1) continue;
+    close(pf->fd[i]);
+    pf->fd[i] = -1;
+    TT.procfds--;
+  }
+  free(pf->str);
+  pf->str = 0;
+  pf->gen = 0;
+}
+
+// Resize table to fit entries seen since generation "gen", freeing the rest.
+static void procfd_rehash(unsigned gen)
+{
+  struct procfd **old = TT.procs, *pf;
+  unsigned i, j, mask = TT.procmask;
+
+  for (i = TT.proccount = 0; i<=mask; i++)
+    if ((pf = old[i]) && pf->gen>=gen) TT.proccount++;
+  for (TT.procmask = 255; TT.procmask<4*TT.proccount;)
+    TT.procmask = 2*TT.procmask+1;
+  TT.procs = xzalloc((TT.procmask+1)*sizeof(*TT.procs));
+
+  for (i = 0; i<=mask; i++) {
+    if (!(pf = old[i])) continue;
+    if (pf->gen<gen) {
+      procfd_reset(pf);
+      free(pf);
+    } else {
+      for (j = pf->tid&TT.procmask; TT.procs[j]; j = (j+1)&TT.procmask);
+      TT.procs[j] = pf;
+    }
+  }
+  free(old);
+}
+
+// Find (or add) tid's entry, if we're caching.
+static struct procfd *procfd_find(long long tid)
+{
+  struct procfd *pf;
+  unsigned i;
+
+  if (!TT.procs) return 0;
+  for (i = tid&TT.procmask; (pf = TT.procs[i]); i = (i+1)&TT.procmask)
+    if (pf->tid == tid) return pf;
+
+  pf = TT.procs[i] = xzalloc(sizeof(struct procfd));
+  pf->tid = tid;
+  memset(pf->fd, -1, sizeof(pf->fd));
+  if (++TT.proccount*2>TT.procmask) procfd_rehash(0);
+
+  return pf;
+}
+
+// Read "$PID/file" (path already in buf) through a cached fd if we have one,
+// keeping enough filehandles free for everything else.
+static char *procfd_read(int dirfd, struct procfd *pf, int which, char *buf,
+  off_t *len)
+{
+  int *fd = (pf && which>=0) ? pf->fd+which : 0;
+  ssize_t l;
+
+  if (fd && *fd == -1 && TT.procfds<TT.maxfds) {
+    if (-1 == (*fd = openat(dirfd, buf, O_RDONLY|O_CLOEXEC))) return 0;
+    TT.procfds++;
+  }
+  if (!fd || *fd == -1) return readfileat(dirfd, buf, buf, len);
+  if (0>(l = pread(*fd, buf, *len-1, 0))) return 0;
+  buf[*len = l] = 0;
+
+  return buf;
+}
+
 static int get_ps(struct dirtree *new)
 {
   struct {
@@ -608,9 +720,11 @@ static int get_ps(struct dirtree *new)
     {"", _PS_NAME}
   };
   struct carveup *tb = (void *)toybuf;
+  struct procfd *pf;
   long long *slot = tb->slot;
+  unsigned long long ll;
   char *name, *s, *buf = tb->str, *end = 0;
-  int i, j, fd;
+  int i, j, fd, neg;
   off_t len;
 
   // Recurse one level into /proc children, skip non-numeric entries
@@ -626,7 +740,19 @@ static int get_ps(struct dirtree *new)
 
   len = 2048;
   sprintf(buf, "%lld/stat", *slot);
-  if (!readfileat(fd, buf, buf, &len)) return 0;
+  if (!procfd_read(fd, pf = procfd_find(*slot), 0, buf, &len)) {
+    // A cached fd for an exited task means the pid got reused, start over.
+    if (!pf || !pf->gen) return 0;
+    procfd_reset(pf);
+    len = 2048;
+    sprintf(buf, "%lld/stat", *slot);
+    if (!procfd_read(fd, pf, 0, buf, &len)) return 0;
+  }
+  if (pf) {
+    pf->gen = TT.procgen;
+    pf->uid = new->st.st_uid;
+    pf->gid = new->st.st_gid;
+  }
 
   // parse oddball fields (name and state). Name can have embedded ')' so match
   // _last_ ')' in stat (although VFS limits filenames to 255 bytes max).
@@ -635,10 +761,19 @@ static int get_ps(struct dirtree *new)
   for (s = ++name; *s; s++) if (*s == ')') end = s;
   if (!end || end-name>255) return 0;
 
-  // Parse numeric fields (starting at 4th field in slot[SLOT_ppid])
-  if (1>sscanf(s = end, ") %c%n", &tb->state, &i)) return 0;
-  for (j = 1; j<SLOT_count; j++)
-    if (1>sscanf(s += i, " %lld%n", slot+j, &i)) break;
+  // Parse numeric fields (starting at 4th field in slot[SLOT_ppid]), but
+  // only as far as the last one we need. Open coded because this is the
+  // hot loop when there are lots of processes.
+  for (s = end+1; isspace(*s); s++);
+  if (!(tb->state = *s++)) return 0;
+  for (j = 1; j<(TT.statlen ? TT.statlen : SLOT_count); j++) {
+    while (*s == ' ') s++;
+    if ((neg = (*s == '-'))) s++;
+    if (!isdigit(*s)) break;
+    for (ll = 0; isdigit(*s); s++) ll = ll*10+*s-'0';
+    if (ll>LLONG_MAX) ll = LLONG_MAX;
+    slot[j] = neg ? -ll : ll;
+  }
 
   // Now we've read the data, move status and name right after slot[] array,
   // and convert low chars to ? for non-tty display while we're at it.
@@ -649,6 +784,12 @@ static int get_ps(struct dirtree *new)
   *buf++ = 0;
   len = sizeof(toybuf)-(buf-toybuf);
 
+  // Saved strings belong to the old program if this task has exec()ed since.
+  if (pf && pf->str && strcmp(pf->str, tb->str)) {
+    free(pf->str);
+    pf->str = 0;
+  }
+
   // save uid, ruid, gid, gid, and rgid int slots 31-34 (we don't use sigcatch
   // or numeric wchan, and the remaining two are always zero), and vmlck into
   // 18 (which is "obsolete, always 0" from stat)
@@ -667,7 +808,7 @@ static int get_ps(struct dirtree *new)
     off_t temp = len;
 
     sprintf(buf, "%lld/status", *slot);
-    if (!readfileat(fd, buf, buf, &temp)) *buf = 0;
+    if (!procfd_read(fd, pf, 1, buf, &temp)) *buf = 0;
     s = strafter(buf, "\nUid:");
     slot[SLOT_ruid] = s ? atol(s) : new->st.st_uid;
     s = strafter(buf, "\nGid:");
@@ -681,7 +822,7 @@ static int get_ps(struct dirtree *new)
     off_t temp = len;
 
     sprintf(buf, "%lld/io", *slot);
-    if (!readfileat(fd, buf, buf, &temp)) *buf = 0;
+    if (!procfd_read(fd, pf, 2, buf, &temp)) *buf = 0;
     if ((s = strafter(buf, "rchar:"))) slot[SLOT_rchar] = atoll(s);
     if ((s = strafter(buf, "wchar:"))) slot[SLOT_wchar] = atoll(s);
     if ((s = strafter(buf, "read_bytes:"))) slot[SLOT_rbytes] = atoll(s);
@@ -704,7 +845,7 @@ static int get_ps(struct dirtree *new)
     off_t temp = len;
 
     sprintf(buf, "%lld/statm", *slot);
-    if (!readfileat(fd, buf, buf, &temp)) *buf = 0;
+    if (!procfd_read(fd, pf, 3, buf, &temp)) *buf = 0;
     
     for (s = buf, i=0; i<3; i++)
       if (!sscanf(s, " %lld%n", slot+SLOT_vsz+i, &j)) slot[SLOT_vsz+i] = 0;
@@ -712,7 +853,8 @@ static int get_ps(struct dirtree *new)
   }
 
   // Do we need to read "exe"?
-  if (TT.bits&_PS_BIT) {
+  if (pf && pf->str) slot[SLOT_bits] = pf->bits;
+  else if (TT.bits&_PS_BIT) {
     off_t temp = 6;
 
     sprintf(buf, "%lld/exe", *slot);
@@ -742,8 +884,15 @@ static int get_ps(struct dirtree *new)
     len = sizeof(toybuf)-(buf-toybuf)-260-256*(ARRAY_LEN(fetch)-j);
     sprintf(buf, "%lld/%s", *slot, fetch[j].name);
 
+    // Strings other than wchan don't change during the life of a process.
+    if (pf && pf->str && j!=1) {
+      if ((i = strlen(s = pf->str+pf->offset[j]))<len) len = i;
+      memcpy(buf, s, len);
+      buf[len] = 0;
+      slot[SLOT_argv0len] = pf->argv0len;
+
     // For exe we readlink instead of read contents
-    if (j==3 || j==5) {
+    } else if (j==3 || j==5) {
       struct carveup *ptb = 0;
       int k;
 
@@ -818,7 +967,7 @@ static int get_ps(struct dirtree *new)
       int temp = 0;
 
       // When command has no arguments, don't space over the NUL
-      if (readfileat(fd, buf, buf, &len) && len>0) {
+      if (procfd_read(fd, pf, (j==1) ? 4 : -1, buf, &len) && len>0) {
 
         // Trim trailing whitespace and NUL bytes
         while (len)
@@ -847,6 +996,14 @@ static int get_ps(struct dirtree *new)
     buf += len+1;
   }
 
+  if (pf && !pf->str) {
+    pf->str = xmalloc(buf-tb->str);
+    memcpy(pf->str, tb->str, buf-tb->str);
+    memcpy(pf->offset, tb->offset, sizeof(pf->offset));
+    pf->argv0len = slot[SLOT_argv0len];
+    pf->bits = slot[SLOT_bits];
+  }
+
   TT.kcount++;
   if (TT.show_process && !TT.threadparent) {
     TT.show_process(tb);
@@ -1150,6 +1307,25 @@ static void shared_main(void)
   }
 }
 
+// Does this ps need to descend into /proc/$PID/task?
+static int ps_threads(void)
+{
+  return (toys.optflags&FLAG_T) || (TT.bits&(_PS_TID|_PS_TCNT));
+}
+
+// Parallel worker: look up one PID under a fake /proc root (see --jobs).
+static void ps_shard(pid_t pid)
+{
+  struct dirtree *dt = TT.shard;
+
+  sprintf(dt->name, "%d", pid);
+  if (fstatat(dirtree_parentfd(dt), dt->name, &dt->st, 0)) return;
+  dt->child = 0;
+  dt->extra = 0;
+  if (ps_threads()) get_threads(dt);
+  else get_ps(dt);
+}
+
 void ps_main(void)
 {
   char **arg;
@@ -1214,12 +1390,22 @@ void ps_main(void)
   // Calculate seen fields bit array, and if we aren't deferring printing
   // print headers now (for low memory/nommu systems).
   TT.bits = get_headers(TT.fields, toybuf, sizeof(toybuf));
+  set_statlen();
   if (!(toys.optflags&FLAG_M)) printf("%.*s\n", TT.width, toybuf);
   if (!(toys.optflags&(FLAG_k|FLAG_M))) TT.show_process = (void *)show_ps;
   TT.match_process = ps_match_process;
-  dt = dirtree_read("/proc",
-    ((toys.optflags&FLAG_T) || (TT.bits&(_PS_TID|_PS_TCNT)))
-      ? get_threads : get_ps);
+  if ((toys.optflags&FLAG_jobs) && TT.show_process) {
+    struct dirtree root;
+
+    memset(&root, 0, sizeof(root));
+    root.dirfd = xopenro("/proc");
+    TT.shard = xzalloc(sizeof(struct dirtree)+24);
+    TT.shard->parent = &root;
+    pids_parallel(TT.ps.jobs, 0, 0, ps_shard, 0);
+    close(root.dirfd);
+    free(TT.shard);
+    dt = 0;
+  } else dt = dirtree_read("/proc", ps_threads() ? get_threads : get_ps);
 
   if (toys.optflags&(FLAG_k|FLAG_M)) {
     struct carveup **tbsort = collate(TT.kcount, dt);
@@ -1248,6 +1434,7 @@ void ps_main(void)
     }
     if (CFG_TOYBOX_FREE) free(tbsort);
   }
+  xflush();
 
   if (CFG_TOYBOX_FREE) {
     free(TT.gg.ptr);
@@ -1299,6 +1486,39 @@ static int merge_deltas(long long *oslot, long long *nslot, int milis)
   return 1;
 }
 
+// Show one process as a line of JSON, with numeric fields as numbers.
+static void show_json(struct carveup *tb, long long when)
+{
+  struct strawberry *field;
+  char *out, *s;
+
+  printf("{\"ms\":%lld", when);
+  for (field = TT.fields; field; field = field->next) {
+    out = string_field(tb, field);
+    printf(",\"%s\":", typos[field->which].name);
+
+    // Is it a JSON number? (Optional minus, no leading zeroes, optional .)
+    s = out+(*out=='-');
+    if (isdigit(*s) && !(*s=='0' && isdigit(s[1]))) {
+      while (isdigit(*s)) s++;
+      if (*s=='.' && isdigit(s[1])) for (s++; isdigit(*s); s++);
+      if (!*s) {
+        fputs(out, stdout);
+        continue;
+      }
+    }
+
+    putchar('"');
+    for (s = out; *s; s++) {
+      if (*s=='"' || *s=='\\') printf("\\%c", *s);
+      else if (*s<' ') printf("\\u%04x", *s);
+      else putchar(*s);
+    }
+    putchar('"');
+  }
+  fputs("}\n", stdout);
+}
+
 static int header_line(int line, int rev)
 {
   if (!line) return 0;
@@ -1320,6 +1540,91 @@ static long long millitime(void)
   return ts.tv_sec*1000+ts.tv_nsec/1000000;
 }
 
+// Subscribe to the kernel's process events connector (needs CAP_NET_ADMIN
+// and CONFIG_PROC_EVENTS), returning -1 if we can't.
+static int proc_events_open(void)
+{
+  struct sockaddr_nl nl;
+  char buf[NLMSG_SPACE(sizeof(struct cn_msg)+sizeof(int))];
+  struct nlmsghdr *nh = (void *)buf;
+  struct cn_msg *cn = NLMSG_DATA(nh);
+  int fd = socket(PF_NETLINK, SOCK_DGRAM|SOCK_NONBLOCK|SOCK_CLOEXEC,
+    NETLINK_CONNECTOR);
+
+  if (fd == -1) return -1;
+  memset(&nl, 0, sizeof(nl));
+  nl.nl_family = AF_NETLINK;
+  nl.nl_groups = CN_IDX_PROC;
+  memset(buf, 0, sizeof(buf));
+  nh->nlmsg_len = NLMSG_LENGTH(sizeof(struct cn_msg)+sizeof(int));
+  nh->nlmsg_type = NLMSG_DONE;
+  cn->id.idx = CN_IDX_PROC;
+  cn->id.val = CN_VAL_PROC;
+  cn->len = sizeof(int);
+  *(int *)cn->data = PROC_CN_MCAST_LISTEN;
+  if (bind(fd, (void *)&nl, sizeof(nl)) || send(fd, buf, nh->nlmsg_len, 0)<0) {
+    close(fd);
+
+    return -1;
+  }
+
+  return fd;
+}
+
+// Drain pending process events. Return 1 if a process started or exited,
+// or changed in a way that needs a fresh look at /proc, or we lost track.
+static int proc_events_changed(void)
+{
+  int len, changed = 0;
+
+  while (0<(len = recv(TT.events, toybuf, sizeof(toybuf), 0))) {
+    struct nlmsghdr *nh = (void *)toybuf;
+
+    for (; NLMSG_OK(nh, len); nh = NLMSG_NEXT(nh, len)) {
+      struct proc_event *ev = (void *)((struct cn_msg *)NLMSG_DATA(nh))->data;
+
+      // New and exiting threads don't change the list of processes.
+      if (ev->what == PROC_EVENT_NONE) continue;
+      if (ev->what == PROC_EVENT_FORK
+        && ev->event_data.fork.child_pid != ev->event_data.fork.child_tgid)
+          continue;
+      if (ev->what == PROC_EVENT_EXIT
+        && ev->event_data.exit.process_pid != ev->event_data.exit.process_tgid)
+          continue;
+      changed++;
+    }
+  }
+
+  // Socket buffer overflowed (ENOBUFS), so we don't know what we missed.
+  return changed || errno != EAGAIN;
+}
+
+// Re-read the processes we already know about, for when proc events say
+// none came or went since we last read the /proc directory.
+static struct carveup **procfd_rescan(void)
+{
+  struct carveup **tb = xmalloc(TT.proccount*sizeof(struct carveup *));
+  struct dirtree root, *dt = xzalloc(sizeof(struct dirtree)+24);
+  struct procfd *pf;
+  unsigned i;
+
+  memset(&root, 0, sizeof(root));
+  root.dirfd = xopenro("/proc");
+  dt->parent = &root;
+  for (i = 0; i<=TT.procmask; i++) {
+    if (!(pf = TT.procs[i])) continue;
+    sprintf(dt->name, "%lld", pf->tid);
+    dt->st.st_uid = pf->uid;
+    dt->st.st_gid = pf->gid;
+    dt->extra = 0;
+    if (get_ps(dt)) tb[TT.kcount-1] = (void *)dt->extra;
+  }
+  close(root.dirfd);
+  free(dt);
+
+  return tb;
+}
+
 static void top_common(
   int (*filter)(long long *oslot, long long *nslot, int milis))
 {
@@ -1329,31 +1634,39 @@ static void top_common(
     int count;
     long long whence;
   } plist[2], *plold, *plnew, old, new, mix;
+  struct carveup **index;
   char scratch[16], *pos, *cpufields[] = {"user", "nice", "sys", "idle",
     "iow", "irq", "sirq", "host"};
  
-  unsigned tock = 0;
-  int i, lines, topoff = 0, done = 0;
+  unsigned tock = 0, mask;
+  int i, j, lines, topoff = 0, done = 0, threads;
 
   toys.signal = SIGWINCH;
   TT.bits = get_headers(TT.fields, toybuf, sizeof(toybuf));
+  set_statlen();
   *scratch = 0;
   memset(plist, 0, sizeof(plist));
   memset(stats, 0, sizeof(stats));
   do {
     struct dirtree *dt;
-    int recalc = 1;
+    int recalc = 1, shown;
 
     plold = plist+(tock++&1);
     plnew = plist+(tock&1);
     plnew->whence = millitime();
-    dt = dirtree_read("/proc",
-      ((toys.optflags&FLAG_H) || (TT.bits&(_PS_TID|_PS_TCNT)))
-        ? get_threads : get_ps);
-    plnew->tb = collate(plnew->count = TT.kcount, dt);
+    TT.procgen++;
+
+    // Rescan /proc for the first sample, or if processes came or went.
+    threads = (toys.optflags&FLAG_H) || (TT.bits&(_PS_TID|_PS_TCNT));
+    if (threads || TT.events == -1 || !plold->tb || proc_events_changed()) {
+      dt = dirtree_read("/proc", threads ? get_threads : get_ps);
+      plnew->tb = collate(TT.kcount, dt);
+    } else plnew->tb = procfd_rescan();
+    plnew->count = TT.kcount;
     TT.kcount = 0;
+    procfd_rehash(TT.procgen);
 
-    if (readfile("/proc/stat", pos = toybuf, sizeof(toybuf))) {
+    if ((pos = reread(&TT.stat, "/proc/stat"))) {
       long long *st = stats+8*(tock&1);
 
       // user nice system idle iowait irq softirq host
@@ -1367,36 +1680,42 @@ static void top_common(
       continue;
     }
 
-    // Collate old and new into "mix", depends on /proc read in pid sort order
+    // Collate old and new into "mix", looking up each new task's previous
+    // sample by tid in a hash table of the old list. Tasks that exited
+    // don't get looked up, and new ones need a second sample for deltas.
     old = *plold;
     new = *plnew;
-    mix.tb = xmalloc((old.count+new.count)*sizeof(struct carveup));
+    for (mask = 255; mask<2*old.count; mask = 2*mask+1);
+    index = xzalloc((mask+1)*sizeof(struct carveup *));
+    for (i = 0; i<old.count; i++) {
+      for (j = old.tb[i]->slot[SLOT_tid]&mask; index[j]; j = (j+1)&mask);
+      index[j] = old.tb[i];
+    }
+    mix.tb = xmalloc(new.count*sizeof(struct carveup *));
     mix.count = 0;
 
-    while (old.count || new.count) {
-      struct carveup *otb = *old.tb, *ntb = *new.tb;
+    for (i = 0; i<new.count; i++) {
+      struct carveup *otb, *ntb = new.tb[i];
 
-      // If we just have old for this process, it exited. Discard it.
-      if (old.count && (!new.count || *otb->slot < *ntb->slot)) {
-        old.tb++;
-        old.count--;
+      for (j = ntb->slot[SLOT_tid]&mask; (otb = index[j]); j = (j+1)&mask)
+        if (otb->slot[SLOT_tid] == ntb->slot[SLOT_tid]) break;
 
+      // Keep or discard
+      if (!otb || !filter(otb->slot, ntb->slot, new.whence-old.whence))
         continue;
-      }
+      mix.tb[mix.count++] = otb;
+    }
+    free(index);
 
-      // If we just have new, use it verbatim
-      if (!old.count || *otb->slot > *ntb->slot) mix.tb[mix.count] = ntb;
-      else {
-        // Keep or discard
-        if (filter(otb->slot, ntb->slot, new.whence-old.whence)) {
-          mix.tb[mix.count] = otb;
-          mix.count++;
-        }
-        old.tb++;
-        old.count--;
-      }
-      new.tb++;
-      new.count--;
+    // -C only displays tasks that used CPU or did I/O, but the header still
+    // counts everything, so move the changed ones to the front of mix.
+    for (shown = i = 0; i<mix.count; i++) {
+      struct carveup *tb = mix.tb[i];
+
+      if ((toys.optflags&FLAG_C) && !tb->slot[SLOT_utime2]
+        && !tb->slot[SLOT_iobytes] && !tb->slot[SLOT_diobytes]) continue;
+      mix.tb[i] = mix.tb[shown];
+      mix.tb[shown++] = tb;
     }
 
     // Don't re-fetch data if it's not time yet, just re-display existing data.
@@ -1404,7 +1723,7 @@ static void top_common(
       char was, is;
 
       if (recalc) {
-        qsort(mix.tb, mix.count, sizeof(struct carveup *), (void *)ksort);
+        qsort(mix.tb, shown, sizeof(struct carveup *), (void *)ksort);
         if (!(toys.optflags&FLAG_b)) {
           printf("\033[H\033[J");
           if (toys.signal) {
@@ -1506,10 +1825,12 @@ static void top_common(
         printf("\033[%dH\033[J", 1+TT.height-lines);
       recalc = 1;
 
-      for (i = 0; i<lines && i+topoff<mix.count; i++) {
+      for (i = 0; i<lines && i+topoff<shown; i++) {
         if (!(toys.optflags&FLAG_b) && i) xputc('\n');
-        show_ps(mix.tb[i+topoff]);
+        if (toys.optflags&FLAG_J) show_json(mix.tb[i+topoff], new.whence);
+        else show_ps(mix.tb[i+topoff]);
       }
+      xflush();
 
       if (TT.top.n && !--TT.top.n) {
         done++;
@@ -1524,8 +1845,8 @@ static void top_common(
       if (toys.optflags&FLAG_b) {
         msleep(timeout-now);
         // Make an obvious gap between datasets.
-        xputs("\n\n");
-        continue;
+        if (!(toys.optflags&FLAG_J)) xputs("\n\n");
+        break;
       }
 
       i = scan_key_getsize(scratch, timeout-now, &TT.width, &TT.height);
@@ -1555,7 +1876,7 @@ static void top_common(
           else if (i == KEY_PGDN) topoff += lines;
           else if (i == KEY_PGUP) topoff -= lines;
           if (topoff<0) topoff = 0; 
-          if (topoff>mix.count) topoff = mix.count;
+          if (topoff>shown) topoff = shown;
         }
       }
       continue;
@@ -1571,7 +1892,20 @@ static void top_common(
 
 static void top_setup(char *defo, char *defk)
 {
+  struct rlimit rl;
+
+  // Cache /proc filehandles between refreshes, leaving some spare.
+  getrlimit(RLIMIT_NOFILE, &rl);
+  rl.rlim_cur = rl.rlim_max;
+  if (setrlimit(RLIMIT_NOFILE, &rl)) getrlimit(RLIMIT_NOFILE, &rl);
+  if (rl.rlim_cur>(1<<20)) rl.rlim_cur = 1<<20;
+  TT.maxfds = (rl.rlim_cur>64) ? rl.rlim_cur-64 : 0;
+  TT.procs = xzalloc(256*sizeof(*TT.procs));
+  TT.procmask = 255;
+  TT.events = proc_events_open();
+
   TT.top.d *= 1000;
+  if (toys.optflags&FLAG_J) toys.optflags |= FLAG_b|FLAG_q;
   if (toys.optflags&FLAG_b) TT.width = TT.height = 99999;
   else {
     TT.time = millitime();
@@ -1737,6 +2071,7 @@ void pgrep_main(void)
     if (!toys.optc) help_exit("No PATTERN");
 
   if (toys.optflags&FLAG_f) TT.bits |= _PS_CMDLINE;
+  set_statlen();
   for (arg = toys.optargs; *arg; arg++) {
     reg = xmalloc(sizeof(struct regex_list));
     xregcomp(&reg->reg, *arg, REG_EXTENDED);
@@ -175,10 +175,10 @@ GLOBALS(
   // processed pattern list
   struct double_list *pattern;
 
-  char *nextline, *remember;
+  char *nextline, *remember, *spare, *outbuf;
   void *restart, *lastregex;
-  long nextlen, rememberlen, count;
-  int fdout, noeol;
+  long nextlen, rememberlen, count, sparelen, outlen;
+  int fdout, noeol, outfd, tty;
   unsigned xx;
 )
 
@@ -196,29 +196,69 @@ struct sedcmd {
   int arg1, arg2, w; // offset of two arguments per command, plus s//w filename
   unsigned not, hit;
   unsigned sflags; // s///flag bits: i=1, g=2, p=4
+  int lit, litlen; // offset and length of s/// pattern with no special chars
+  int replen; // length of s/// replacement, or -1 if it has backrefs
   char c; // action
 };
 
-// Write out line with potential embedded NUL, handling eol/noeol
-static int emit(char *line, long len, int eol)
+#define OUTBUF_SIZE 65536
+
+// Write out buffered output, then switch buffer to fd
+static int flush_out(int fd)
 {
-  int l, old = line[len];
+  long len = TT.outlen;
 
-  if (TT.noeol && !writeall(TT.fdout, "\n", 1)) return 1;
-  TT.noeol = !eol;
-  if (eol) line[len++] = '\n';
-  if (!len) return 0;
-  l = writeall(TT.fdout, line, len);
-  if (eol) line[len-1] = old;
-  if (l != len) {
+  TT.outlen = 0;
+  if (len && writeall(TT.outfd, TT.outbuf, len) != len) {
     perror_msg("short write");
 
     return 1;
   }
+  TT.outfd = fd;
 
   return 0;
 }
 
+static void flush_handler(int sig)
+{
+  if (!sig) flush_out(TT.outfd);
+}
+
+// Append to output buffer, writing big chunks straight through
+static int out(char *s, long len)
+{
+  int rc = 0;
+
+  if (TT.outlen+len > OUTBUF_SIZE) rc = flush_out(TT.outfd);
+  if (len >= OUTBUF_SIZE) {
+    if (writeall(TT.outfd, s, len) == len) return rc;
+    perror_msg("short write");
+
+    return 1;
+  }
+  memcpy(TT.outbuf+TT.outlen, s, len);
+  TT.outlen += len;
+
+  return rc;
+}
+
+// Write out line with potential embedded NUL, handling eol/noeol. Output is
+// collected in one buffer and flushed when the destination changes, so w
+// files and stdout are written in order.
+static int emit(char *line, long len, int eol)
+{
+  int rc = 0;
+
+  if (TT.outfd != TT.fdout) rc = flush_out(TT.fdout);
+  if (TT.noeol) rc |= out("\n", 1);
+  TT.noeol = !eol;
+  rc |= out(line, len);
+  if (eol) rc |= out("\n", 1);
+  if (TT.tty && TT.outfd == 1) rc |= flush_out(1);
+
+  return rc;
+}
+
 // Extend allocation to include new string, with newline between if newlen<0
 
 static char *extend_string(char **old, char *new, int oldlen, int newlen)
@@ -246,6 +286,22 @@ static void *get_regex(void *trump, int offset)
   return TT.lastregex = offset+(char *)trump;
 }
 
+// Find next s/// match, using memmem() when the pattern is a plain string
+static int s_match(struct sedcmd *command, regex_t *reg, char *line, long len,
+  regmatch_t *match, int flags)
+{
+  char *s;
+  int i;
+
+  if (!command->lit) return regexec0(reg, line, len, 10, match, flags);
+  if (!(s = memmem(line, len, command->lit+(char *)command, command->litlen)))
+    return 1;
+  match[0].rm_eo = (match[0].rm_so = s-line)+command->litlen;
+  for (i = 1; i<10; i++) match[i].rm_so = match[i].rm_eo = -1;
+
+  return 0;
+}
+
 // Apply pattern to line from input file
 static void process_line(char **pline, long plen)
 {
@@ -386,7 +442,7 @@ static void process_line(char **pline, long plen)
       continue;
     } else if (c=='g') {
       free(line);
-      line = xstrdup(TT.remember);
+      line = xmemdup(TT.remember, TT.rememberlen+1);
       len = TT.rememberlen;
     } else if (c=='G') {
       line = xrealloc(line, len+TT.rememberlen+2);
@@ -395,7 +451,7 @@ static void process_line(char **pline, long plen)
       line[len += TT.rememberlen] = 0;
     } else if (c=='h') {
       free(TT.remember);
-      TT.remember = xstrdup(line);
+      TT.remember = xmemdup(line, len+1);
       TT.rememberlen = len;
     } else if (c=='H') {
       TT.remember = xrealloc(TT.remember, TT.rememberlen+len+2);
@@ -463,10 +519,11 @@ static void process_line(char **pline, long plen)
       char *rline = line, *new = command->arg2 + (char *)command, *swap, *rswap;
       regmatch_t *match = (void *)toybuf;
       regex_t *reg = get_regex(command, command->arg1);
-      int mflags = 0, count = 0, zmatch = 1, rlen = len, mlen, off, newlen;
+      int mflags = 0, count = 0, zmatch = 1, rlen = len, mlen, off, newlen,
+        backref;
 
       // Find match in remaining line (up to remaining len)
-      while (!regexec0(reg, rline, rlen, 10, match, mflags)) {
+      while (!s_match(command, reg, rline, rlen, match, mflags)) {
         mflags = REG_NOTBOL;
 
         // Zero length matches don't count immediately after a previous match
@@ -491,7 +548,8 @@ static void process_line(char **pline, long plen)
         if (match[0].rm_eo > INT_MAX) perror_exit(0);
 
         // newlen = strlen(new) but with \1 and & and printf escapes
-        for (off = newlen = 0; new[off]; off++) {
+        if (0 <= (newlen = command->replen)) backref = 0;
+        else for (off = newlen = backref = 0; new[off]; off++) {
           int cc = -1;
 
           if (new[off] == '&') cc = 0;
@@ -501,15 +559,24 @@ static void process_line(char **pline, long plen)
             continue;
           }
           newlen += match[cc].rm_eo-match[cc].rm_so;
+          backref++;
         }
 
-        // Allocate new size, copy start/end around match. (Can't extend in
-        // place because backrefs may refer to text after it's overwritten.)
+        // Allocate new size, copy start/end around match. Without backrefs
+        // we can edit in place, otherwise they may refer to text after it's
+        // overwritten so build a new copy.
         len += newlen-mlen;
-        swap = xmalloc(len+1);
+        if (backref) {
+          swap = xmalloc(len+1);
+          memcpy(swap, line, (rline-line)+match[0].rm_so);
+        } else {
+          off = rline-line;
+          if (newlen>mlen) line = xrealloc(line, len+1);
+          rline = line+off;
+          swap = line;
+        }
         rswap = swap+(rline-line)+match[0].rm_so;
-        memcpy(swap, line, (rline-line)+match[0].rm_so);
-        memcpy(rswap+newlen, rline+match[0].rm_eo, (rlen -= match[0].rm_eo)+1);
+        memmove(rswap+newlen, rline+match[0].rm_eo, (rlen -= match[0].rm_eo)+1);
 
         // copy in new replacement text
         for (off = mlen = 0; new[off]; off++) {
@@ -535,8 +602,10 @@ static void process_line(char **pline, long plen)
         }
 
         rline = rswap+newlen;
-        free(line);
-        line = swap;
+        if (swap != line) {
+          free(line);
+          line = swap;
+        }
 
         // Stop after first substitution unless we have flag g
         if (!(command->sflags & 2)) break;
@@ -608,6 +677,7 @@ done:
 
       // Force newline if noeol pending
       if (fd != -1) {
+        flush_out(TT.fdout);
         if (TT.noeol) xwrite(TT.fdout, "\n", 1);
         TT.noeol = 0;
         xsendfile(fd, TT.fdout);
@@ -618,7 +688,38 @@ done:
     free(append);
     append = a;
   }
-  free(line);
+
+  // Recycle the buffer for the next getline()
+  if (line && !TT.spare) {
+    TT.spare = line;
+    TT.sparelen = len+1;
+  } else free(line);
+}
+
+// Feed lines of input to process_line() reusing a spare buffer, so
+// steady state needs no allocation per line
+static void read_lines(int fd)
+{
+  FILE *fp = fd ? xfdopen(fd, "r") : stdin;
+
+  for (;;) {
+    char *line = TT.spare;
+    size_t size = TT.sparelen;
+    long len;
+
+    TT.spare = 0;
+    len = getline(&line, &size, fp);
+    if (len < 1) {
+      TT.spare = line;
+      TT.sparelen = size;
+
+      break;
+    }
+    process_line(&line, len);
+    if (line == (void *)1) break;
+  }
+
+  if (fd) fclose(fp);
 }
 
 // Callback called on each input file
@@ -639,9 +740,10 @@ static void do_sed(int fd, char *name)
     for (command = (void *)TT.pattern; command; command = command->next)
       command->hit = 0;
   }
-  do_lines(fd, process_line);
+  read_lines(fd);
   if (i) {
     process_line(0, 0);
+    flush_out(TT.fdout);
     replace_tempfile(-1, TT.fdout, &tmp);
     TT.fdout = 1;
     TT.nextline = 0;
@@ -874,8 +976,30 @@ resume_s:
       // We deferred actually parsing the regex until we had the s///i flag
       // allocating the space was done by extend_string() above
       if (!*TT.remember) command->arg1 = 0;
-      else xregcomp((void *)(command->arg1 + (char *)command), TT.remember,
-        ((toys.optflags & FLAG_r)*REG_EXTENDED)|((command->sflags&1)*REG_ICASE));
+      else {
+        xregcomp((void *)(command->arg1 + (char *)command), TT.remember,
+          ((toys.optflags & FLAG_r)*REG_EXTENDED)
+          |((command->sflags&1)*REG_ICASE));
+
+        // Plain strings can skip regexec()
+        if (!(command->sflags&1) && !strpbrk(TT.remember,
+          (toys.optflags & FLAG_r) ? "\\.[*^$+?({|" : "\\.[*^$"))
+        {
+          command->lit = reg-(char *)command;
+          command->litlen = strlen(TT.remember);
+          reg = extend_string((void *)&command, TT.remember, command->lit,
+            command->litlen);
+        }
+      }
+
+      // Replacement without & or \N is the same length every time
+      for (end = command->arg2+(char *)command, i = 0; *end; end++, i++) {
+        if (*end == '&' || (*end == '\\' && (!*++end || isdigit(*end)))) {
+          i = -1;
+          break;
+        }
+      }
+      command->replen = i;
       free(TT.remember);
       TT.remember = 0;
       if (*line == 'w') {
@@ -1021,13 +1145,17 @@ void sed_main(void)
   dlist_terminate(TT.pattern);
   if (TT.nextlen) error_exit("no }");  
 
-  TT.fdout = 1;
+  TT.fdout = TT.outfd = 1;
+  TT.tty = isatty(1);
+  TT.outbuf = xmalloc(OUTBUF_SIZE);
+  sigatexit(flush_handler);
   TT.remember = xstrdup("");
 
   // Inflict pattern upon input files. Long version because !O_CLOEXEC
   loopfiles_rw(args, O_RDONLY|WARN_ONLY, 0, do_sed);
 
   if (!(toys.optflags & FLAG_i)) process_line(0, 0);
+  flush_out(TT.outfd);
 
   // todo: need to close fd when done for TOYBOX_FREE?
 }
@@ -35,55 +35,89 @@ GLOBALS(
   char *outfile;
 )
 
+// Close previous output file (if any) and create the next one in sequence
+static int next_file(int outfd, unsigned long filenum, mode_t mode)
+{
+  char *s = TT.outfile + strlen(TT.outfile);
+  int i;
+
+  for (i = 0; i<TT.suflen; i++) {
+    *(--s) = 'a'+(filenum%26);
+    filenum /= 26;
+  }
+  if (filenum) error_exit("bad suffix");
+  if (outfd != -1) close(outfd);
+
+  return xcreate(TT.outfile, O_RDWR|O_CREAT|O_TRUNC, mode & 0777);
+}
+
 static void do_split(int infd, char *in)
 {
   unsigned long bytesleft, linesleft, filenum, len, pos;
   int outfd = -1;
+  char *buf = xmalloc(65536);
   struct stat st;
+  off_t off;
 
   // posix doesn't cover permissions on output file, so copy input (or 0777)
   st.st_mode = 0777;
   fstat(infd, &st);
 
   len = pos = filenum = bytesleft = linesleft = 0;
+
+  // Splitting a file by size doesn't need to read the data: have the kernel
+  // copy it (or share the blocks). If it can't, the loop below resumes at off.
+  if (TT.bytes && !TT.lines && S_ISREG(st.st_mode)
+      && -1 != (off = lseek(infd, 0, SEEK_CUR)))
+  {
+    while (off < st.st_size) {
+      long l = st.st_size-off;
+
+      if (!bytesleft) {
+        outfd = next_file(outfd, filenum++, st.st_mode);
+        bytesleft = TT.bytes;
+      }
+      if (l > bytesleft) l = bytesleft;
+      if (1 > (l = copy_range(infd, &off, outfd, l))) break;
+      bytesleft -= l;
+    }
+    lseek(infd, off, SEEK_SET);
+  }
+
   for (;;) {
-    int i, j;
+    int j;
 
-    // Refill toybuf?
+    // Refill buffer?
     if (len == pos) {
-      if (!(len = xread(infd, toybuf, sizeof(toybuf)))) break;
+      if (!(len = xread(infd, buf, 65536))) break;
       pos = 0;
     }
 
     // Start new output file?
     if ((TT.bytes && !bytesleft) || (TT.lines && !linesleft)) {
-      char *s = TT.outfile + strlen(TT.outfile);
-
-      j = filenum++;
-      for (i = 0; i<TT.suflen; i++) {
-        *(--s) = 'a'+(j%26);
-        j /= 26;
-      }
-      if (j) error_exit("bad suffix");
+      outfd = next_file(outfd, filenum++, st.st_mode);
       bytesleft = TT.bytes;
       linesleft = TT.lines;
-      if (outfd != -1) close(outfd);
-      outfd = xcreate(TT.outfile, O_RDWR|O_CREAT|O_TRUNC, st.st_mode & 0777);
     }
 
     // Write next chunk of output.
     if (TT.lines) {
-      for (i = pos; i < len; ) {
-        if (toybuf[i++] == '\n' && !--linesleft) break;
-        if (!--bytesleft) break;
+      char *s = buf+pos, *end = buf+len, *nl;
+
+      if (TT.bytes && end-s > bytesleft) end = s+bytesleft;
+      while ((nl = memchr(s, '\n', end-s))) {
+        s = nl+1;
+        if (!--linesleft) break;
       }
-      j = i - pos;
+      if (!nl) s = end;
+      j = s-(buf+pos);
+      if (TT.bytes) bytesleft -= j;
     } else {
       j = len - pos;
       if (j > bytesleft) j = bytesleft;
       bytesleft -= j;
     }
-    xwrite(outfd, toybuf+pos, j);
+    xwrite(outfd, buf+pos, j);
     pos += j;
   }
 
@@ -91,6 +125,7 @@ static void do_split(int infd, char *in)
     if (outfd != -1) close(outfd);
     if (infd) close(infd);
     free(TT.outfile);
+    free(buf);
   }
   xexit();
 }
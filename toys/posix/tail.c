@@ -6,13 +6,13 @@
  *
  * Deviations from posix: -f waits for pipe/fifo on stdin (nonblock?).
 
-USE_TAIL(NEWTOY(tail, "?fc-n-[-cn]", TOYFLAG_USR|TOYFLAG_BIN))
+USE_TAIL(NEWTOY(tail, "?fFc-n-[-cn]", TOYFLAG_USR|TOYFLAG_BIN))
 
 config TAIL
   bool "tail"
   default y
   help
-    usage: tail [-n|c NUMBER] [-f] [FILE...]
+    usage: tail [-n|c NUMBER] [-fF] [FILE...]
 
     Copy last lines from files to stdout. If no files listed, copy from
     stdin. Filename "-" is a synonym for stdin.
@@ -20,6 +20,7 @@ config TAIL
     -n	output the last NUMBER lines (default 10), +X counts from start.
     -c	output the last NUMBER bytes, +NUMBER counts from start
     -f	follow FILE(s), waiting for more data to be appended
+    -F	follow FILE(s) by name, reopening them when rotated or deleted
 
 config TAIL_SEEK
   bool "tail seek support"
@@ -37,7 +38,8 @@ GLOBALS(
   long lines;
   long bytes;
 
-  int file_no, ffd, *files;
+  int file_no, ffd, *files, last, missing;
+  char **names;
 )
 
 struct line_list {
@@ -76,7 +78,7 @@ static void dump_chunk(void *ptr)
 static int try_lseek(int fd, long bytes, long lines)
 {
   struct line_list *list = 0, *temp;
-  int flag = 0, chunk = sizeof(toybuf);
+  int flag = 0, chunk = 65536;
   off_t pos = lseek(fd, 0, SEEK_END);
 
   // If lseek() doesn't work on this stream, return now.
@@ -93,6 +95,7 @@ static int try_lseek(int fd, long bytes, long lines)
 
   bytes = pos;
   while (lines && pos) {
+    char *s;
     int offset;
 
     // Read in next chunk from end of file
@@ -106,14 +109,15 @@ static int try_lseek(int fd, long bytes, long lines)
     temp->next = list;
     list = temp;
 
-    // Count newlines in this chunk.
+    // Count newlines in this chunk. If the last line ends with a newline,
+    // that one doesn't count.
     offset = list->len;
-    while (offset--) {
-      // If the last line ends with a newline, that one doesn't count.
-      if (!flag) flag++;
+    if (!flag++) offset--;
+    while (offset>0 && (s = memrchr(list->data, '\n', offset))) {
+      offset = s-list->data;
 
       // Start outputting data right after newline
-      else if (list->data[offset] == '\n' && !++lines) {
+      if (!++lines) {
         offset++;
         list->data += offset;
         list->len -= offset;
@@ -131,6 +135,77 @@ static int try_lseek(int fd, long bytes, long lines)
   return 1;
 }
 
+static unsigned follow_mask(void)
+{
+  return IN_MODIFY
+    | ((toys.optflags&FLAG_F) ? IN_MOVE_SELF|IN_DELETE_SELF|IN_ATTRIB : 0);
+}
+
+// Copy new data from followed file, starting over if it was truncated
+static void follow_read(int i)
+{
+  int fd = TT.files[i*3], len;
+  struct stat st;
+
+  if (!fstat(fd, &st) && S_ISREG(st.st_mode)
+    && st.st_size < lseek(fd, 0, SEEK_CUR))
+  {
+    error_msg("%s: file truncated", TT.names[i]);
+    lseek(fd, 0, SEEK_SET);
+  }
+
+  while ((len = read(fd, libbuf, sizeof(libbuf)))>0) {
+    if (TT.last != i) {
+      TT.last = i;
+      xprintf("\n==> %s <==\n", TT.names[i]);
+    }
+
+    xwrite(1, libbuf, len);
+  }
+}
+
+// For -F: if name no longer refers to the file we're reading, finish
+// reading the old one and switch to the new one. Until something shows up
+// under that name, keep reading the old one and check again later.
+static void follow_check(int i)
+{
+  int *ff = TT.files+i*3, fd;
+  struct stat st1, st2;
+  char buf[32];
+
+  // stdin can't be reopened
+  if (!ff[0]) return;
+
+  if (-1 == (fd = open(TT.names[i], O_RDONLY))) {
+    if (!ff[2]++) TT.missing++;
+
+    return;
+  }
+  if (ff[2]) {
+    ff[2] = 0;
+    TT.missing--;
+  }
+
+  if (!fstat(fd, &st1) && !fstat(*ff, &st2) && st1.st_dev == st2.st_dev
+      && st1.st_ino == st2.st_ino)
+  {
+    close(fd);
+
+    return;
+  }
+
+  follow_read(i);
+  inotify_rm_watch(TT.ffd, ff[1]);
+  close(*ff);
+  *ff = fd;
+
+  // Watch the file we opened, not whatever the name points to later
+  sprintf(buf, "/proc/self/fd/%d", fd);
+  ff[1] = inotify_add_watch(TT.ffd, buf, follow_mask());
+  error_msg("%s: following new file", TT.names[i]);
+  follow_read(i);
+}
+
 // Called for each file listed on command line, and/or stdin
 static void do_tail(int fd, char *name)
 {
@@ -138,13 +213,15 @@ static void do_tail(int fd, char *name)
   int linepop = 1;
 
   if (toys.optflags & FLAG_f) {
-    int f = TT.file_no*2;
+    int f = TT.file_no*3;
     char *s = name;
 
     if (!fd) sprintf(s = toybuf, "/proc/self/fd/%d", fd);
+    TT.names[TT.file_no] = name;
     TT.files[f++] = fd;
-    if (0 > (TT.files[f] = inotify_add_watch(TT.ffd, s, IN_MODIFY)))
+    if (0 > (TT.files[f++] = inotify_add_watch(TT.ffd, s, follow_mask())))
       perror_msg("bad -f on '%s'", name);
+    TT.files[f] = 0;
   }
 
   if (TT.file_no++) xputc('\n');
@@ -237,33 +314,43 @@ void tail_main(void)
     }
   }
 
-  // Allocate 2 ints per optarg for -f
+  // Allocate 3 ints and a name per optarg for -f
+  if (toys.optflags&FLAG_F) toys.optflags |= FLAG_f;
   if (toys.optflags&FLAG_f) {
     if ((TT.ffd = inotify_init()) < 0) perror_exit("inotify_init");
-    TT.files = xmalloc(toys.optc*8);
+    TT.files = xmalloc((toys.optc+1)*3*sizeof(int));
+    TT.names = xmalloc((toys.optc+1)*sizeof(char *));
   }
   loopfiles_rw(args, O_RDONLY|WARN_ONLY|(O_CLOEXEC*!(toys.optflags&FLAG_f)),
     0, do_tail);
 
   if ((toys.optflags & FLAG_f) && TT.file_no) {
-    int len, last_fd = TT.files[(TT.file_no-1)*2], i, fd;
-    struct inotify_event ev;
+    struct pollfd pfd;
+    struct inotify_event *ev;
+    int len, i;
 
+    TT.last = TT.file_no-1;
+    pfd.fd = TT.ffd;
+    pfd.events = POLLIN;
     for (;;) {
-      if (sizeof(ev)!=read(TT.ffd, &ev, sizeof(ev))) perror_exit("inotify");
-
-      for (i = 0; i<TT.file_no && ev.wd!=TT.files[(i*2)+1]; i++);
-      if (i==TT.file_no) continue;
-      fd = TT.files[i*2];
-
-      // Read new data.
-      while ((len = read(fd, toybuf, sizeof(toybuf)))>0) {
-        if (last_fd != fd) {
-          last_fd = fd;
-          xprintf("\n==> %s <==\n", args[i]);
-        }
-
-        xwrite(1, toybuf, len);
+      // Check once a second for rotated files that haven't reappeared yet
+      if (TT.missing) for (i = 0; i<TT.file_no; i++)
+        if (TT.files[i*3+2]) follow_check(i);
+      if (!poll(&pfd, 1, TT.missing ? 1000 : -1)) continue;
+
+      // Handle all pending events from one read
+      if (1>(len = read(TT.ffd, toybuf, sizeof(toybuf))))
+        perror_exit("inotify");
+      for (ev = (void *)toybuf; (char *)ev < toybuf+len;
+        ev = (void *)(ev->len+(char *)(ev+1)))
+      {
+        for (i = 0; i<TT.file_no && ev->wd!=TT.files[(i*3)+1]; i++);
+        if (i==TT.file_no) continue;
+
+        // Read new data.
+        follow_read(i);
+        if (ev->mask & (IN_MOVE_SELF|IN_DELETE_SELF|IN_ATTRIB))
+          follow_check(i);
       }
     }
   }
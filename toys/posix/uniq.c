@@ -4,16 +4,17 @@
  *
  * See http://opengroup.org/onlinepubs/9699919799/utilities/uniq.html
 
-USE_UNIQ(NEWTOY(uniq, "f#s#w#zicdu", TOYFLAG_USR|TOYFLAG_BIN))
+USE_UNIQ(NEWTOY(uniq, "f#s#w#zicduA(hash)", TOYFLAG_USR|TOYFLAG_BIN))
 
 config UNIQ
   bool "uniq"
   default y
   help
-    usage: uniq [-cduiz] [-w maxchars] [-f fields] [-s char] [input_file [output_file]]
+    usage: uniq [-cduizA] [-w maxchars] [-f fields] [-s char] [input_file [output_file]]
 
     Report or filter out repeated lines in a file
 
+    -A	--hash: also match non-adjacent lines (input needn't be sorted)
     -c	show counts before each line
     -d	show only lines that are repeated
     -u	show only lines that are unique
@@ -50,6 +51,21 @@ static char *skip(char *str)
   return str;
 }
 
+// Return part of line to compare
+static char *key(char *line)
+{
+  return (TT.nfields || TT.nchars) ? skip(line) : line;
+}
+
+static int keycmp(char *t1, char *t2)
+{
+  if (!TT.maxchars)
+    return !(toys.optflags & FLAG_i) ? strcmp(t1, t2) : strcasecmp(t1, t2);
+
+  return !(toys.optflags & FLAG_i) ? strncmp(t1, t2, TT.maxchars)
+    : strncasecmp(t1, t2, TT.maxchars);
+}
+
 static void print_line(FILE *f, char *line)
 {
   if (toys.optflags & (TT.repeats ? FLAG_u : FLAG_d)) return;
@@ -58,10 +74,83 @@ static void print_line(FILE *f, char *line)
   if (toys.optflags & FLAG_z) fputc(0, f);
 }
 
+// Count matching lines anywhere in the input with an open addressing hash
+// table, then output each in order of first appearance.
+static void uniq_hash(FILE *infile, FILE *outfile, char eol)
+{
+  struct uniq_line {
+    char *line, *key;
+    unsigned long hash, count;
+  } *lines = 0;
+  unsigned long nlines = 0, size = 0, *table = 0, i, h;
+  char *line = 0;
+  size_t linesize = 0;
+  long len;
+
+  while (0 < (len = getdelim(&line, &linesize, eol, infile))) {
+    char *k, *ss;
+    long n = TT.maxchars;
+
+    // Terminate last line like the others so it matches and prints the same
+    if (line[len-1] != eol) {
+      line = xrealloc(line, len+2);
+      line[len++] = eol;
+      line[len] = 0;
+    }
+
+    // FNV-1a of the compared part of the line
+    for (h = 2166136261U, ss = k = key(line); *ss && (!TT.maxchars || n--);)
+      h = (h^((toys.optflags & FLAG_i) ? tolower(*ss++) : *ss++))*16777619;
+
+    // Grow table when 3/4 full, rehashing existing entries.
+    if (nlines*4 >= size*3) {
+      free(table);
+      table = xzalloc((size = size ? size*2 : 1024)*sizeof(long));
+      for (i = 0; i<nlines; i++) {
+        unsigned long j = lines[i].hash&(size-1);
+
+        while (table[j]) j = (j+1)&(size-1);
+        table[j] = i+1;
+      }
+    }
+
+    for (i = h&(size-1); table[i]; i = (i+1)&(size-1)) {
+      struct uniq_line *ul = lines+table[i]-1;
+
+      if (ul->hash == h && !keycmp(k, ul->key)) break;
+    }
+
+    if (table[i]) lines[table[i]-1].count++;
+    else {
+      if (!(nlines&1023))
+        lines = xrealloc(lines, (nlines+1024)*sizeof(struct uniq_line));
+      lines[nlines].line = line;
+      lines[nlines].key = k;
+      lines[nlines].hash = h;
+      lines[nlines].count = 0;
+      table[i] = ++nlines;
+      line = 0;
+      linesize = 0;
+    }
+  }
+
+  for (i = 0; i<nlines; i++) {
+    TT.repeats = lines[i].count;
+    print_line(outfile, lines[i].line);
+    if (CFG_TOYBOX_FREE) free(lines[i].line);
+  }
+
+  if (CFG_TOYBOX_FREE) {
+    free(line);
+    free(lines);
+    free(table);
+  }
+}
+
 void uniq_main(void)
 {
   FILE *infile = stdin, *outfile = stdout;
-  char *thisline = NULL, *prevline = NULL, *tmpline, eol = '\n';
+  char *thisline = NULL, *prevline = NULL, *prevkey, *tmpline, eol = '\n';
   size_t thissize, prevsize = 0, tmpsize;
 
   if (toys.optc >= 1) infile = xfopen(toys.optargs[0], "r");
@@ -69,31 +158,21 @@ void uniq_main(void)
 
   if (toys.optflags & FLAG_z) eol = 0;
 
+  if (toys.optflags & FLAG_A) {
+    uniq_hash(infile, outfile, eol);
+
+    goto done;
+  }
+
   // If first line can't be read
   if (getdelim(&prevline, &prevsize, eol, infile) < 0)
     return;
+  prevkey = key(prevline);
 
   while (getdelim(&thisline, &thissize, eol, infile) > 0) {
-    int diff;
-    char *t1, *t2;
-
-    // If requested get the chosen fields + character offsets.
-    if (TT.nfields || TT.nchars) {
-      t1 = skip(thisline);
-      t2 = skip(prevline);
-    } else {
-      t1 = thisline;
-      t2 = prevline;
-    }
-
-    if (TT.maxchars == 0) {
-      diff = !(toys.optflags & FLAG_i) ? strcmp(t1, t2) : strcasecmp(t1, t2);
-    } else {
-      diff = !(toys.optflags & FLAG_i) ? strncmp(t1, t2, TT.maxchars)
-              : strncasecmp(t1, t2, TT.maxchars);
-    }
+    char *t1 = key(thisline);
 
-    if (diff == 0) { // same
+    if (!keycmp(t1, prevkey)) { // same
       TT.repeats++;
     } else {
       print_line(outfile, prevline);
@@ -103,6 +182,7 @@ void uniq_main(void)
       tmpline = prevline;
       prevline = thisline;
       thisline = tmpline;
+      prevkey = t1;
 
       tmpsize = prevsize;
       prevsize = thissize;
@@ -112,6 +192,7 @@ void uniq_main(void)
 
   print_line(outfile, prevline);
 
+done:
   if (CFG_TOYBOX_FREE) {
     if (outfile != stdout) fclose(outfile);
     if (infile != stdin) fclose(infile);
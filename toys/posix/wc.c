@@ -29,8 +29,11 @@ config WC
 
 GLOBALS(
   unsigned long totals[4];
+  char *buf;
 )
 
+#define WC_BUFSIZE 65536
+
 static void show_lengths(unsigned long *lengths, char *name)
 {
   int i, space = 7, first = 1;
@@ -47,6 +50,23 @@ static void show_lengths(unsigned long *lengths, char *name)
   xputc('\n');
 }
 
+// Count newlines a word at a time: xor turns '\n' bytes into zero bytes,
+// then the high bit of each byte ends up set unless the byte was zero.
+static unsigned long count_lines(char *s, int len)
+{
+  unsigned long count = 0, ones = -1UL/255, high = ones*128, x;
+
+  for (; len >= sizeof(long); len -= sizeof(long), s += sizeof(long)) {
+    memcpy(&x, s, sizeof(long));
+    x ^= ones*'\n';
+    x = ((x&~high)+~high)|x;
+    count += ((((~x)&high)>>7)*ones)>>(8*sizeof(long)-8);
+  }
+  while (len--) count += *s++ == '\n';
+
+  return count;
+}
+
 static void do_wc(int fd, char *name)
 {
   int len = 0, clen = 1, space = 0;
@@ -64,29 +84,47 @@ static void do_wc(int fd, char *name)
   }
 
   for (;;) {
-    int pos, done = 0, len2 = read(fd, toybuf+len, sizeof(toybuf)-len);
+    int pos, done = 0, len2 = read(fd, TT.buf+len, WC_BUFSIZE-len);
 
     if (len2<0) perror_msg_raw(name);
     else len += len2;
     if (len2<1) done++;
 
+    // Just lines and bytes doesn't need to look at each character
+    if (!(toys.optflags&(FLAG_w|FLAG_m))) {
+      lengths[0] += count_lines(TT.buf, len);
+      lengths[2] += len;
+      len = 0;
+      if (done) break;
+
+      continue;
+    }
+
     for (pos = 0; pos<len; pos++) {
-      if (toybuf[pos]=='\n') lengths[0]++;
+      char c = TT.buf[pos];
+
+      if (c=='\n') lengths[0]++;
       lengths[2]++;
       if (toys.optflags&FLAG_m) {
         // If we've consumed next wide char
         if (--clen<1) {
           wchar_t wchar;
 
-          // next wide size, don't count invalid, fetch more data if necessary
-          clen = mbrtowc(&wchar, toybuf+pos, len-pos, 0);
-          if (clen == -1) continue;
-          if (clen == -2 && !done) break;
+          // ascii is one char, else next wide size, don't count invalid,
+          // fetch more data if necessary
+          if (c<128) {
+            clen = 1;
+            wchar = c;
+          } else {
+            clen = mbrtowc(&wchar, TT.buf+pos, len-pos, 0);
+            if (clen == -1) continue;
+            if (clen == -2 && !done) break;
+          }
 
           lengths[3]++;
           space = iswspace(wchar);
         }
-      } else space = isspace(toybuf[pos]);
+      } else space = isspace(c);
 
       if (space) word=0;
       else {
@@ -95,7 +133,7 @@ static void do_wc(int fd, char *name)
       }
     }
     if (done) break;
-    if (pos != len) memmove(toybuf, toybuf+pos, len-pos);
+    if (pos != len) memmove(TT.buf, TT.buf+pos, len-pos);
     len -= pos;
   }
 
@@ -106,6 +144,7 @@ show:
 void wc_main(void)
 {
   if (!toys.optflags) toys.optflags = FLAG_l|FLAG_w|FLAG_c;
+  TT.buf = xmalloc(WC_BUFSIZE);
   loopfiles(toys.optargs, do_wc);
   if (toys.optc>1) show_lengths(TT.totals, "total");
 }
@@ -6,13 +6,13 @@
  *
  * TODO: Rich's whitespace objection, env size isn't fixed anymore.
 
-USE_XARGS(NEWTOY(xargs, "^I:E:L#ptxrn#<1s#0", TOYFLAG_USR|TOYFLAG_BIN))
+USE_XARGS(NEWTOY(xargs, "^I:E:L#ptxrn#<1s#0P#<0", TOYFLAG_USR|TOYFLAG_BIN))
 
 config XARGS
   bool "xargs"
   default y
   help
-    usage: xargs [-ptxr0] [-s NUM] [-n NUM] [-L NUM] [-E STR] COMMAND...
+    usage: xargs [-ptxr0] [-s NUM] [-n NUM] [-L NUM] [-E STR] [-P NUM] COMMAND...
 
     Run command line one or more times, appending arguments from stdin.
 
@@ -21,6 +21,7 @@ config XARGS
     -s	Size in bytes per command line
     -n	Max number of arguments per command
     -0	Each argument is NULL terminated, no whitespace or quote processing
+    -P	Run up to NUM commands at once (0 = one per processor)
     #-p	Prompt for y/n from tty before running each command
     #-t	Trace, print command line to stderr
     #-x	Exit if can't fit everything in one command
@@ -41,14 +42,15 @@ config XARGS_PEDANTIC
 #include "toys.h"
 
 GLOBALS(
+  long P;
   long max_bytes;
   long max_entries;
   long L;
   char *eofstr;
   char *I;
 
-  long entries, bytes;
-  char delim;
+  long entries, bytes, running;
+  char delim, stop;
 )
 
 // If out==NULL count TT.bytes and TT.entries, stopping at max.
@@ -106,14 +108,33 @@ static char *handle_entries(char *data, char **entry)
   return NULL;
 }
 
+// Reap a child, folding its exit status into ours the way posix wants:
+// 123 if any command failed, 124 (and launch no more) if one exited 255,
+// 125 if one was killed by a signal, 126/127 if it couldn't be run.
+static void xargs_wait(void)
+{
+  int status;
+
+  while (-1 == wait(&status) && errno == EINTR);
+  TT.running--;
+
+  if (!WIFEXITED(status)) toys.exitval = 125;
+  else if (255 == (status = WEXITSTATUS(status))) {
+    toys.exitval = 124;
+    TT.stop++;
+  } else if (status == 126 || status == 127) toys.exitval = status;
+  else if (status && !toys.exitval) toys.exitval = 123;
+}
+
 void xargs_main(void)
 {
   struct double_list *dlist = NULL, *dtemp;
-  int entries, bytes, done = 0, status;
+  int entries, bytes, done = 0, ran = 0;
   char *data = NULL, **out;
-  pid_t pid;
 
   if (!(toys.optflags & FLAG_0)) TT.delim = '\n';
+  if (!(toys.optflags & FLAG_P)) TT.P = 1;
+  else if (!TT.P) TT.P = sysconf(_SC_NPROCESSORS_ONLN);
 
   // If no optargs, call echo.
   if (!toys.optc) {
@@ -158,7 +179,12 @@ void xargs_main(void)
 
     // Accumulate cally thing
 
-    if (data && !TT.entries) error_exit("argument too long");
+    if (data && !TT.entries) {
+      while (TT.running) xargs_wait();
+      error_exit("argument too long");
+    }
+    // Input ran out right after a full batch? Don't run an empty one.
+    if (!TT.entries && ran) break;
     out = xzalloc((entries+TT.entries+1)*sizeof(char *));
 
     // Fill out command line to exec
@@ -169,13 +195,16 @@ void xargs_main(void)
     for (dtemp = dlist; dtemp; dtemp = dtemp->next)
       handle_entries(dtemp->data, out+entries);
 
-    if (!(pid = XVFORK())) {
+    // Keep up to -P commands running, reading more input while they do.
+    while (TT.running >= TT.P && !TT.stop) xargs_wait();
+    if (TT.stop) break;
+    if (!XVFORK()) {
       xclose(0);
       open("/dev/null", O_RDONLY);
       xexec(out);
     }
-    waitpid(pid, &status, 0);
-    status = WIFEXITED(status) ? WEXITSTATUS(status) : WTERMSIG(status)+127;
+    TT.running++;
+    ran++;
 
     // Abritrary number of execs, can't just leak memory each time...
     while (dlist) {
@@ -187,4 +216,5 @@ void xargs_main(void)
     }
     free(out);
   }
+  while (TT.running) xargs_wait();
 }